@@ -0,0 +1,181 @@
+#include "container.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#pragma once
+
+namespace aosoa {
+namespace internal {
+
+template<typename C>
+inline static constexpr bool is_aosoa = std::is_base_of_v<AosoaContainer<std::remove_cvref_t<C>>, std::remove_cvref_t<C>>;
+
+template<typename C>
+inline static constexpr size_t num_columns = soa::num_columns<typename aosoa_traits<std::remove_cvref_t<C>>::types>;
+
+// Element type of the I-th scalar column.
+template<typename C, size_t I>
+using column_t = std::remove_cvref_t<decltype(*std::declval<std::remove_cvref_t<C>&>().template column_data<I>(0))>;
+
+// Columns are stored in contiguous segments: the frames of Aosoa containers,
+// otherwise the whole container.
+template<typename C>
+inline static constexpr size_t segment_capacity = aosoa_traits<std::remove_cvref_t<C>>::frame_size;
+
+template<typename C>
+FORCE_INLINE size_t num_segments(const C& c) {
+    if constexpr (is_aosoa<C>)
+        return c.num_frames();
+    else
+        return c.size() > 0 ? 1 : 0;
+}
+
+template<typename C>
+FORCE_INLINE size_t segment_size(const C& c, size_t seg) {
+    if constexpr (is_aosoa<C>)
+        return std::min(segment_capacity<C>, c.size() - seg * segment_capacity<C>);
+    else
+        return c.size();
+}
+
+// Call fn(integral_constant<size_t, I>) for every scalar column I of C.
+template<typename C, typename Fn>
+FORCE_INLINE void for_each_column(Fn&& fn) {
+    tpa::constexpr_for<0, num_columns<C>, 1>(std::forward<Fn>(fn));
+}
+
+// Sequential writer of the I-th column, starting at element `idx`. The
+// segment is only looked up when the first element in it is written.
+template<size_t I, typename C>
+class ColumnWriter {
+    public:
+        static constexpr size_t capacity = segment_capacity<C>;
+
+        FORCE_INLINE ColumnWriter(C& c, size_t idx) :
+            m_c(c), m_seg(idx / capacity), m_offset(idx % capacity), m_ptr(nullptr) {}
+
+        template<typename T>
+        FORCE_INLINE void push(T&& value) {
+            if (m_offset == capacity) [[unlikely]] {
+                ++m_seg;
+                m_offset = 0;
+                m_ptr = nullptr;
+            }
+            if (m_ptr == nullptr) [[unlikely]]
+                m_ptr = m_c.template column_data<I>(m_seg);
+            m_ptr[m_offset++] = std::forward<T>(value);
+        }
+
+    private:
+        C& m_c;
+        size_t m_seg, m_offset;
+        column_t<C, I>* m_ptr;
+};
+
+// Bitmask of a predicate result: a xsimd batch_bool, a bitmask or a bool.
+template<typename M>
+FORCE_INLINE uint64_t mask_bits(const M& m) {
+    if constexpr (requires { m.mask(); })
+        return static_cast<uint64_t>(m.mask());
+    else
+        return static_cast<uint64_t>(m);
+}
+
+FORCE_INLINE bool test_bit(const std::vector<uint64_t>& bits, size_t pos) {
+    return (bits[pos/64] >> (pos%64)) & 1;
+}
+
+// OR the lowest `count` bits of `value` into `bits`, starting at bit `pos`.
+FORCE_INLINE void set_bits(std::vector<uint64_t>& bits, size_t pos, uint64_t value, size_t count) {
+    if (count < 64)
+        value &= (uint64_t(1) << count) - 1;
+    const size_t shift = pos % 64;
+    bits[pos/64] |= value << shift;
+    if (shift > 0 and shift + count > 64)
+        bits[pos/64+1] |= value >> (64 - shift);
+}
+
+}  // namespace internal
+
+/**
+ * Keep the elements whose bit is set in `keep` (bit i%64 of keep[i/64] for
+ * element i), in order, and shrink the container to them. Survivors are
+ * moved column by column, skipping the removed elements 64 at a time.
+ * Returns the number of removed elements.
+ */
+template<typename C>
+size_t compact(C& c, const std::vector<uint64_t>& keep) {
+    constexpr size_t capacity = internal::segment_capacity<C>;
+    const size_t size = c.size();
+
+    // Elements before the first removed one stay in place.
+    size_t first = size;
+    for (size_t w = 0; w * 64 < size; ++w) {
+        if (~keep[w] != 0) {
+            first = std::min(size, w * 64 + std::countr_zero(~keep[w]));
+            break;
+        }
+    }
+    if (first == size)
+        return 0;
+
+    // Bits of [first, size) only: first is in a word, size may end one.
+    size_t kept = first;
+    for (size_t w = first / 64; w * 64 < size; ++w) {
+        uint64_t word = keep[w];
+        if (w == first / 64)
+            word &= ~uint64_t(0) << (first % 64);
+        if (size - w * 64 < 64)
+            word &= (uint64_t(1) << (size - w * 64)) - 1;
+        kept += std::popcount(word);
+    }
+
+    const size_t num_segs = internal::num_segments(c);
+    internal::for_each_column<C>([&](auto I) {
+        constexpr size_t i = decltype(I)::value;
+        internal::ColumnWriter<i, C> out(c, first);
+        for (size_t seg = first / capacity; seg < num_segs; ++seg) {
+            const auto* src = c.template column_data<i>(seg);
+            const size_t base = seg * capacity,
+                         hi = base + internal::segment_size(c, seg);
+            size_t k = std::max(first, base);
+            while (k < hi) {
+                const size_t word_end = std::min(hi, (k/64 + 1) * 64);
+                uint64_t word = keep[k/64] >> (k%64);
+                if (word_end - k < 64)
+                    word &= (uint64_t(1) << (word_end - k)) - 1;
+                while (word) {
+                    out.push(src[k - base + std::countr_zero(word)]);
+                    word &= word - 1;
+                }
+                k = word_end;
+            }
+        }
+    });
+
+    c.resize(kept);
+    return size - kept;
+}
+
+/**
+ * Remove the elements for which `pred` is true, keeping the order of the
+ * others. `pred` is called on S-lane batches of `mrange<S>()` and returns a
+ * xsimd batch_bool (or a bitmask), lanes outside of the container are
+ * ignored. Returns the number of removed elements.
+ */
+template<size_t S, typename C, typename Pred>
+    requires( S > 0 and S <= 64 )
+size_t remove_if(C& c, Pred&& pred) {
+    std::vector<uint64_t> keep((c.size() + 63) / 64, 0);
+    const C& cc = c;
+    for (auto p : cc.template mrange<S>()) {
+        uint64_t removed = internal::mask_bits(pred(p));
+        internal::set_bits(keep, p.index(), ~removed & p.bits(), p.count());
+    }
+    return compact(c, keep);
+}
+
+}  // namespace aosoa
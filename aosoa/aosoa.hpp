@@ -2,3 +2,22 @@
 #include "aosoa_list.hpp"
 #include "aosoa_vector.hpp"
 #include "soa_vector.hpp"
+#include "hot_cold.hpp"
+#include "parallel.hpp"
+#include "work_stealing.hpp"
+#include "algorithm.hpp"
+#include "tombstone.hpp"
+#include "sort.hpp"
+#include "binning.hpp"
+#include "reorder.hpp"
+#include "reduce.hpp"
+#include "scan.hpp"
+#include "field.hpp"
+#include "expr.hpp"
+#include "zip.hpp"
+#include "dispatch.hpp"
+#include "wide.hpp"
+#include "quantized.hpp"
+#include "bitfield.hpp"
+#include "view.hpp"
+#include "column.hpp"
@@ -0,0 +1,106 @@
+#include "soa.hpp"
+#include "predeclarition.hpp"
+#include <type_traits>
+
+#pragma once
+
+namespace aosoa {
+
+/**
+ * Iterator of Aosoa containers. Caches the current frame and the offset in
+ * it, so sequential access does not divide by the frame size, and loads the
+ * next frame only when crossing a frame boundary.
+ */
+template<typename B, size_t S, bool const_iter>
+class AosoaIter {
+    public:
+        using Base = std::conditional_t<const_iter, const B, B>;
+        using Frame = std::remove_reference_t<decltype(std::declval<Base&>().frame(0))>;
+        using base_types = typename aosoa_traits<std::remove_cvref_t<Base>>::types;
+        using self_types = std::conditional_t<const_iter, typename soa::const_types<base_types>::type, base_types>;
+        using difference_type = std::ptrdiff_t;
+        // S != 0 should not be used in std algorithms
+        using value_type = std::conditional_t<S==0, soa::SoaElem<self_types>, void>;
+        using reference = std::conditional_t<S==0, soa::SoaRef<self_types>, soa::SoaRefN<self_types, S>>;
+        using iterator_category = std::random_access_iterator_tag;
+        using Self = AosoaIter<B, S, const_iter>;
+        static constexpr std::ptrdiff_t step_size = S == 0 ? 1 : S;
+        static constexpr size_t frame_size = aosoa_traits<std::remove_cvref_t<Base>>::frame_size;
+
+        FORCE_INLINE AosoaIter() : m_data(nullptr), m_frame(nullptr), m_index(0), m_frame_idx(0), m_offset(0) {}
+        FORCE_INLINE AosoaIter(Base* base, size_t index) : m_data(base), m_index(index) { seek(); }
+        FORCE_INLINE AosoaIter(const AosoaIter& other) = default;
+
+        FORCE_INLINE auto operator*() const {
+            if constexpr (S == 0)
+                return (*m_frame)[m_offset];
+            else
+                return m_frame->template get<S>(m_offset);
+        }
+
+        FORCE_INLINE size_t index() const { return m_index; }
+        FORCE_INLINE Base* data() const { return m_data; }
+        FORCE_INLINE Frame* frame() const { return m_frame; }
+        FORCE_INLINE size_t offset() const { return m_offset; }
+
+        FORCE_INLINE auto& operator++() {
+            m_index += step_size;
+            m_offset += step_size;
+            if (m_offset >= frame_size) [[unlikely]] {
+                m_offset -= frame_size;
+                load_frame(m_frame_idx + 1);
+            }
+            return *this;
+        }
+        FORCE_INLINE auto operator++(int) { auto ret = *this; ++(*this); return ret; }
+
+        FORCE_INLINE auto& operator--() {
+            m_index -= step_size;
+            if (m_offset < size_t(step_size)) [[unlikely]] {
+                m_offset += frame_size - step_size;
+                load_frame(m_frame_idx - 1);
+            }
+            else
+                m_offset -= step_size;
+            return *this;
+        }
+        FORCE_INLINE auto operator--(int) { auto ret = *this; --(*this); return ret; }
+
+        FORCE_INLINE auto& operator+=(std::ptrdiff_t offset) { m_index += offset * step_size; seek(); return *this; }
+        FORCE_INLINE auto& operator-=(std::ptrdiff_t offset) { m_index -= offset * step_size; seek(); return *this; }
+
+        FORCE_INLINE auto operator+(std::ptrdiff_t offset) const { return Self(m_data, m_index + offset * step_size); }
+        FORCE_INLINE auto operator-(std::ptrdiff_t offset) const { return Self(m_data, m_index - offset * step_size); }
+
+        FORCE_INLINE auto operator[](std::ptrdiff_t offset) const { return *Self(m_data, m_index + offset * step_size); }
+
+        FORCE_INLINE auto operator-(const Self& other) const { return (difference_type(m_index) - difference_type(other.index())) / step_size; }
+
+        FORCE_INLINE bool operator==(const Self& other) const { return m_index == other.index(); }
+        FORCE_INLINE bool operator>=(const Self& other) const { return m_index >= other.index(); }
+        FORCE_INLINE bool operator<=(const Self& other) const { return m_index <= other.index(); }
+        FORCE_INLINE bool operator<(const Self& other) const { return m_index < other.index(); }
+        FORCE_INLINE bool operator>(const Self& other) const { return m_index > other.index(); }
+
+        FORCE_INLINE AosoaIter& operator=(const AosoaIter& other) = default;
+
+    private:
+        Base *m_data;
+        Frame *m_frame;
+        size_t m_index, m_frame_idx, m_offset;
+
+        FORCE_INLINE void seek() {
+            m_offset = m_index % frame_size;
+            load_frame(m_index / frame_size);
+        }
+
+        // Frames past the used ones are never dereferenced, do not touch them.
+        FORCE_INLINE void load_frame(size_t idx) {
+            m_frame_idx = idx;
+            m_frame = idx < m_data->num_frames() ? &m_data->frame(idx) : nullptr;
+        }
+};
+template<typename B, size_t S, bool const_iter>
+FORCE_INLINE auto operator+(std::ptrdiff_t offset, const AosoaIter<B, S, const_iter>& si) { return si + offset; }
+
+}  // namespace aosoa
@@ -1,6 +1,7 @@
 #include "container.hpp"
 #include "soa_array.hpp"
 #include "aosoa_utils.hpp"
+#include "frame_pool.hpp"
 
 #include <memory>
 
@@ -9,15 +10,20 @@
 namespace aosoa {
 
 
-template<typename Types, size_t N, size_t align>
-class AosoaList : public AosoaContainer<AosoaList<Types, N, align>> {
+template<typename Types, size_t N, size_t align, bool padded>
+class AosoaList : public AosoaContainer<AosoaList<Types, N, align, padded>> {
     public:
-        using Frame = SoaArray<Types, N, align>;
-        using Frame_ptr = std::unique_ptr<Frame>;
-        using Base = AosoaContainer<AosoaList<Types, N, align>>;
+        using Frame = SoaArray<Types, N, align, padded>;
+        using Pool = FramePool<Frame>;
+        using Frame_ptr = std::unique_ptr<Frame, FrameDeleter<Frame>>;
+        using Base = AosoaContainer<AosoaList<Types, N, align, padded>>;
         using Base::frame_size,
               Base::elem_size;
 
+        AosoaList() = default;
+        // Frames are taken from `pool` and returned to it, see FramePool.
+        explicit AosoaList(Pool* pool) : m_pool(pool) {}
+
         // Implement Container API
         FORCE_INLINE size_t size() const {
             if (m_used_frames == 0) return 0;
@@ -28,21 +34,36 @@ class AosoaList : public AosoaContainer<AosoaList<Types, N, align>> {
         }
 
         // Implement AosoaContainer API
+        FORCE_INLINE size_t num_frames() const { return m_used_frames; }
         FORCE_INLINE Frame& frame(size_t idx) { return *(m_data[idx]); }
         FORCE_INLINE const Frame& frame(size_t idx) const { return *(m_data[idx]); }
 
-        FORCE_INLINE void resize(size_t new_size) {
-            m_last_frame_num = new_size % frame_size;
-            m_used_frames = (new_size + frame_size - 1) / frame_size;
-            while (m_data.size() < m_used_frames)
-                m_data.emplace_back(std::make_unique<SoaArray<Types, N, align>>());
+        FORCE_INLINE void resize(size_t new_size) { resize_frames<true>(new_size); }
+        // Resize leaving new frames uninitialized, for elements about to be overwritten.
+        FORCE_INLINE void resize_for_overwrite(size_t new_size) { resize_frames<false>(new_size); }
+        // Allocate the frames of `capacity` elements. Like the frames kept by
+        // `clear`, they are not zeroed when `resize` starts using them.
+        FORCE_INLINE void reserve(size_t capacity) {
+            const size_t frames = (capacity + frame_size - 1) / frame_size;
+            m_data.reserve(frames);
+            while (m_data.size() < frames)
+                m_data.emplace_back(new_frame<false>());
+        }
+        FORCE_INLINE void clear() {
+            m_used_frames = 0;
+            m_last_frame_num = 0;
+            if (m_pool)
+                m_data.clear();
         }
-        FORCE_INLINE void clear() { m_used_frames = 0; m_last_frame_num = 0; }
 
         // Other methods
         FORCE_INLINE auto& data() const { return m_data; }
         FORCE_INLINE auto& data() { return m_data; }
 
+        FORCE_INLINE Pool* pool() const { return m_pool; }
+        // Take new frames from `pool`, or the heap if null. Frames already held go back where they came from.
+        FORCE_INLINE void set_pool(Pool* pool) { m_pool = pool; }
+
         FORCE_INLINE bool full() const {
             return m_used_frames == m_data.size() and m_last_frame_num == 0;
         }
@@ -128,7 +149,7 @@ class AosoaList : public AosoaContainer<AosoaList<Types, N, align>> {
                 resize(num + start);
                 size_t start_frame = start / frame_size,
                        start_index = start % frame_size;
-                internal::AosoaBuffer<Types, N, align> abuf(buf, num);
+                internal::AosoaBuffer<Types, N, align, padded> abuf(buf, num);
                 // First, try fill first frame
                 auto n = abuf.fill(*m_data[start_frame], start_index);
                 // If there's element(s) left, fill them to the next frame.
@@ -147,7 +168,7 @@ class AosoaList : public AosoaContainer<AosoaList<Types, N, align>> {
                 void *mid_start = (char*)buf + num_head * elem_size;
                 void *tail_start = (char*)mid_start + num_frame_full * frame_size * elem_size;
 
-                internal::AosoaBuffer<Types, N, align> buf_head(buf, num_head),
+                internal::AosoaBuffer<Types, N, align, padded> buf_head(buf, num_head),
                                       buf_tail(tail_start, num_tail);
 
                 start_index = buf_head.fill(*m_data[start_frame], start_index);
@@ -200,7 +221,7 @@ class AosoaList : public AosoaContainer<AosoaList<Types, N, align>> {
             }
         }
 
-        void move_merge(size_t start, size_t other_start, AosoaList<Types, N, align>& other) {
+        void move_merge(size_t start, size_t other_start, AosoaList<Types, N, align, padded>& other) {
             size_t other_end = other.size();
             bool one_framed = other_start / frame_size == other_end / frame_size;
             if (one_framed) {
@@ -220,14 +241,14 @@ class AosoaList : public AosoaContainer<AosoaList<Types, N, align>> {
                             m_data[start/frame_size]->merge(start%frame_size, other_start%frame_size, cap, *(other.data()[other_start/frame_size]));
                             if (m_data.size() <= start/frame_size + 1) {
                                 m_used_frames += 1;
-                                m_data.emplace_back(std::make_unique<SoaArray<Types, N, align>>());
+                                m_data.emplace_back(new_frame());
                             }
                             m_data[start/frame_size+1]->merge(0, (other_start+cap)%frame_size, num-cap, *(other.data()[other_start/frame_size]));
                         }
                         else {
                             if (m_data.size() <= start/frame_size) {
                                 m_used_frames += 1;
-                                m_data.emplace_back(std::make_unique<SoaArray<Types, N, align>>());
+                                m_data.emplace_back(new_frame());
                             }
                             m_data[start/frame_size]->merge(0, other_start%frame_size, num, *(other.data()[other_start/frame_size]));
                         }
@@ -307,7 +328,7 @@ class AosoaList : public AosoaContainer<AosoaList<Types, N, align>> {
                     if (num_head > 0) {
                         // we may need to allocate a new frame
                         if (m_data.size() <= start_frame)
-                            m_data.emplace_back(std::make_unique<SoaArray<Types, N, align>>());
+                            m_data.emplace_back(new_frame());
                         m_data[start_frame]->merge(0, frame_size-num_head, num_head, *(other.data()[other_start/frame_size]));
                     }
                     if (full_end > full_start)
@@ -322,8 +343,35 @@ class AosoaList : public AosoaContainer<AosoaList<Types, N, align>> {
 
     private:
         std::vector<Frame_ptr> m_data;
-        size_t m_used_frames;
-        size_t m_last_frame_num;
+        size_t m_used_frames = 0;
+        size_t m_last_frame_num = 0;
+        Pool* m_pool = nullptr;
+
+        template<bool zero = true>
+        Frame_ptr new_frame() {
+            if (m_pool) {
+                Frame* frame = m_pool->acquire();
+                if constexpr (zero)
+                    std::construct_at(frame);
+                return Frame_ptr(frame, FrameDeleter<Frame>{m_pool});
+            }
+            if constexpr (zero)
+                return Frame_ptr(new Frame());
+            else
+                return Frame_ptr(new Frame);
+        }
+
+        template<bool zero>
+        FORCE_INLINE void resize_frames(size_t new_size) {
+            const size_t old_frames = m_used_frames;
+            m_last_frame_num = new_size % frame_size;
+            m_used_frames = (new_size + frame_size - 1) / frame_size;
+            while (m_data.size() < m_used_frames)
+                m_data.emplace_back(new_frame<zero>());
+            // With a pool, a shrinking list returns its spare frames.
+            if (m_pool and m_used_frames < old_frames)
+                m_data.resize(m_used_frames);
+        }
 };
 
 } // namespace aosoa
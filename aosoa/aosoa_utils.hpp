@@ -1,12 +1,34 @@
 #include "container.hpp"
 #include <algorithm>
+#include <memory>
+#include <new>
+#include <utility>
 
 #pragma once
 
 namespace aosoa {
 namespace internal {
 
-template<typename Types, size_t N, size_t align>
+// Allocator A whose construction without arguments default-initializes, so
+// that growing a std::vector of trivial types leaves the new elements
+// uninitialized, see `resize_for_overwrite`.
+template<typename T, typename A>
+class default_init_allocator : public A {
+    using traits = std::allocator_traits<A>;
+
+    public:
+        template<typename U>
+        struct rebind { using other = default_init_allocator<U, typename traits::template rebind_alloc<U>>; };
+
+        using A::A;
+
+        template<typename U>
+        void construct(U* p) noexcept(std::is_nothrow_default_constructible_v<U>) { ::new (static_cast<void*>(p)) U; }
+        template<typename U, typename...Args>
+        void construct(U* p, Args&&...args) { traits::construct(static_cast<A&>(*this), p, std::forward<Args>(args)...); }
+};
+
+template<typename Types, size_t N, size_t align, bool padded>
 class AosoaBuffer {
 
     public:
@@ -14,7 +36,7 @@ class AosoaBuffer {
 
         size_t left() const { return m_num - m_idx; }
 
-        size_t fill(SoaArray<Types, N, align>& arr, size_t start) {
+        size_t fill(SoaArray<Types, N, align, padded>& arr, size_t start) {
             size_t cap = N - start, l = left();
             if (l == 0) return start;
             if (cap > l) {
@@ -1,20 +1,22 @@
 #include "container.hpp"
+#include "column.hpp"
 #include "soa_array.hpp"
 #include "aosoa_utils.hpp"
 
 #include <vector>
 #include <cstdint>
+#include <memory>
 #include <xsimd/xsimd.hpp>
 
 #pragma once
 
 namespace aosoa {
 
-template<typename Types, size_t N, size_t align>
-class AosoaVector : public AosoaContainer<AosoaVector<Types, N, align>> {
+template<typename Types, size_t N, size_t align, bool padded>
+class AosoaVector : public AosoaContainer<AosoaVector<Types, N, align, padded>> {
     public:
-        using Frame = SoaArray<Types, N, align>;
-        using Base = AosoaContainer<AosoaVector<Types, N, align>>;
+        using Frame = SoaArray<Types, N, align, padded>;
+        using Base = AosoaContainer<AosoaVector<Types, N, align, padded>>;
         using Base::frame_size,
               Base::elem_size;
 
@@ -28,20 +30,34 @@ class AosoaVector : public AosoaContainer<AosoaVector<Types, N, align>> {
         }
 
         // Implement AosoaContainer API
+        FORCE_INLINE size_t num_frames() const { return m_used_frames; }
         FORCE_INLINE Frame& frame(size_t idx) { return m_data[idx]; }
         FORCE_INLINE const Frame& frame(size_t idx) const { return m_data[idx]; }
 
         FORCE_INLINE void resize(size_t new_size) {
+            const size_t old_frames = m_data.size();
+            resize_for_overwrite(new_size);
+            for (size_t i = old_frames; i < m_data.size(); ++i)
+                std::construct_at(&m_data[i]);
+        }
+        // Resize leaving new frames uninitialized, for elements about to be overwritten.
+        FORCE_INLINE void resize_for_overwrite(size_t new_size) {
             m_last_frame_num = new_size % frame_size;
             m_used_frames = (new_size + frame_size - 1) / frame_size;
             m_data.resize(m_used_frames);
         }
+        FORCE_INLINE void reserve(size_t capacity) { m_data.reserve((capacity + frame_size - 1) / frame_size); }
         FORCE_INLINE void clear() { m_used_frames = 0; m_last_frame_num = 0; m_data.resize(0); }
 
         // Other methods
         FORCE_INLINE auto& data() const { return m_data; }
         FORCE_INLINE auto& data() { return m_data; }
 
+        // Component K of the field F as a StridedColumn, whose frames are
+        // contiguous spans, e.g. `pa.column<pos, 1>()`. See column.hpp.
+        template<template<typename, size_t> typename F, size_t K = 0> auto column() { return make_column<F, K>(this); }
+        template<template<typename, size_t> typename F, size_t K = 0> auto column() const { return make_column<F, K>(this); }
+
         FORCE_INLINE bool full() const {
             return m_used_frames == m_data.size() and m_last_frame_num == 0;
         }
@@ -96,10 +112,16 @@ class AosoaVector : public AosoaContainer<AosoaVector<Types, N, align>> {
                 // write head
                 buf = m_data[current_frame++].write(start % frame_size, frame_size, buf);
                 // write mid
-                auto full_size = num_frame_full*frame_size*elem_size;
-                std::memcpy(buf, &m_data[current_frame], full_size);
-                buf = (char*)buf + full_size;
-                current_frame += num_frame_full;
+                if constexpr (frames_packed) {
+                    auto full_size = num_frame_full*frame_size*elem_size;
+                    std::memcpy(buf, &m_data[current_frame], full_size);
+                    buf = (char*)buf + full_size;
+                    current_frame += num_frame_full;
+                }
+                else {
+                    for (size_t i = 0; i < num_frame_full; ++i)
+                        buf = m_data[current_frame++].write(0, frame_size, buf);
+                }
                 // write tail
                 if (num_tail > 0)
                     buf = m_data[current_frame++].write(0, end % frame_size, buf);
@@ -129,7 +151,7 @@ class AosoaVector : public AosoaContainer<AosoaVector<Types, N, align>> {
                 resize(num + start);
                 size_t start_frame = start / frame_size,
                        start_index = start % frame_size;
-                internal::AosoaBuffer<Types, N, align> abuf(buf, num);
+                internal::AosoaBuffer<Types, N, align, padded> abuf(buf, num);
                 // First, try fill first frame
                 auto n = abuf.fill(frame(start_frame), start_index);
                 // If there's element(s) left, fill them to the next frame.
@@ -148,7 +170,7 @@ class AosoaVector : public AosoaContainer<AosoaVector<Types, N, align>> {
                 void *mid_start = (char*)buf + num_head * elem_size;
                 void *tail_start = (char*)mid_start + num_frame_full * frame_size * elem_size;
 
-                internal::AosoaBuffer<Types, N, align> buf_head(buf, num_head),
+                internal::AosoaBuffer<Types, N, align, padded> buf_head(buf, num_head),
                                       buf_tail(tail_start, num_tail);
 
                 start_index = buf_head.fill(frame(start_frame), start_index);
@@ -190,7 +212,15 @@ class AosoaVector : public AosoaContainer<AosoaVector<Types, N, align>> {
                     }
                 }
 
-                std::memcpy(&m_data[start_frame], mid_start, elem_size*frame_size*num_frame_full);
+                if constexpr (frames_packed) {
+                    std::memcpy(&m_data[start_frame], mid_start, elem_size*frame_size*num_frame_full);
+                }
+                else {
+                    for (size_t i = 0; i < num_frame_full; ++i) {
+                        m_data[start_frame+i].read_full(mid_start);
+                        mid_start = (char*)mid_start + frame_size * elem_size;
+                    }
+                }
 
                 return (char*)buf + elem_size * num;
 
@@ -198,9 +228,13 @@ class AosoaVector : public AosoaContainer<AosoaVector<Types, N, align>> {
         }
 
     private:
-        std::vector<Frame, xsimd::aligned_allocator<Frame, align>> m_data;
-        size_t m_used_frames;
-        size_t m_last_frame_num;
+        // Whether consecutive frames have the same memory layout as the
+        // serialized data, i.e. no padding inside or between frames.
+        static constexpr bool frames_packed = sizeof(Frame) == frame_size * elem_size;
+
+        std::vector<Frame, internal::default_init_allocator<Frame, xsimd::aligned_allocator<Frame, align>>> m_data;
+        size_t m_used_frames = 0;
+        size_t m_last_frame_num = 0;
 };
 
 }  // namespace aosoa
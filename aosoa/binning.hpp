@@ -0,0 +1,95 @@
+#include "sort.hpp"
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+#pragma once
+
+namespace aosoa {
+namespace internal {
+
+// Copy `count` elements of every column from src, starting at src_start, to
+// dst, starting at dst_start, in runs that do not cross segment boundaries.
+template<typename D, typename S>
+void copy_columns(D& dst, size_t dst_start, const S& src, size_t src_start, size_t count) {
+    static_assert(std::is_same_v<typename aosoa_traits<D>::types, typename aosoa_traits<S>::types>,
+            "containers must have the same element types");
+    constexpr size_t src_cap = segment_capacity<S>, dst_cap = segment_capacity<D>;
+    for_each_column<S>([&](auto I) {
+        constexpr size_t i = decltype(I)::value;
+        for (size_t k = 0; k < count;) {
+            const size_t s = src_start + k, d = dst_start + k;
+            const size_t len = std::min({count - k, src_cap - s % src_cap, dst_cap - d % dst_cap});
+            std::copy_n(src.template column_data<i>(s / src_cap) + s % src_cap, len,
+                    dst.template column_data<i>(d / dst_cap) + d % dst_cap);
+            k += len;
+        }
+    });
+}
+
+}  // namespace internal
+
+/**
+ * Move all elements of `src` to the buckets given by `cell_fn`, e.g.
+ * `bin(pa, [](auto p) { return p.cell(); }, cells)`, appending them to the
+ * buckets and leaving `src` empty. Cell indices must be in [0, buckets.size()).
+ *
+ * A counting pass with per-thread histograms and a scatter pass give the
+ * permutation grouping the elements by bucket, which is applied column-wise.
+ * If `src` has the type of the buckets, the groups are then moved from the
+ * end of `src` with `move_merge`, which moves whole frames; otherwise they are
+ * copied column-wise, the buckets in parallel.
+ */
+template<typename C, typename KeyFn, typename Bucket>
+void bin(C& src, KeyFn&& cell_fn, std::vector<Bucket>& buckets, ThreadPool& pool = default_thread_pool()) {
+    const size_t n = src.size(), num_buckets = buckets.size(), nc = internal::num_chunks(n, pool);
+
+    std::vector<size_t> cells(n);
+    std::vector<std::vector<size_t>> offsets(nc, std::vector<size_t>(num_buckets, 0));
+    pool.run(nc, [&](size_t t) {
+        size_t k = internal::chunk_begin(n, t, nc);
+        const size_t e = internal::chunk_begin(n, t+1, nc);
+        for (auto it = std::as_const(src).begin() + k; k < e; ++it, ++k) {
+            cells[k] = cell_fn(*it);
+            ++offsets[t][cells[k]];
+        }
+    });
+
+    std::vector<size_t> starts(num_buckets + 1);
+    size_t sum = 0;
+    for (size_t b = 0; b < num_buckets; ++b) {
+        starts[b] = sum;
+        for (size_t t = 0; t < nc; ++t) {
+            size_t count = offsets[t][b];
+            offsets[t][b] = sum;
+            sum += count;
+        }
+    }
+    starts[num_buckets] = n;
+
+    std::vector<size_t> perm(n);
+    pool.run(nc, [&](size_t t) {
+        auto& offset = offsets[t];
+        for (size_t k = internal::chunk_begin(n, t, nc), e = internal::chunk_begin(n, t+1, nc); k < e; ++k)
+            perm[offset[cells[k]]++] = k;
+    });
+    internal::gather_columns(src, perm, pool);
+
+    if constexpr (std::is_same_v<C, Bucket> and requires { src.move_merge(0, 0, src); }) {
+        // the group of the last bucket is always at the end of src
+        for (size_t b = num_buckets; b-- > 0;)
+            if (starts[b] < starts[b+1])
+                buckets[b].move_merge(buckets[b].size(), starts[b], src);
+    }
+    else {
+        pool.run(num_buckets, [&](size_t b) {
+            const size_t count = starts[b+1] - starts[b], old_size = buckets[b].size();
+            if (count == 0) return;
+            buckets[b].resize(old_size + count);
+            internal::copy_columns(buckets[b], old_size, src, starts[b], count);
+        });
+        src.resize(0);
+    }
+}
+
+}  // namespace aosoa
@@ -0,0 +1,140 @@
+#include "predeclarition.hpp"
+#include "wide.hpp"
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <xsimd/xsimd.hpp>
+
+#pragma once
+
+namespace aosoa {
+
+/**
+ * Flags and small enums packed into one unsigned word per element, e.g.
+ * `state<uint8_t>` holding `alive = bitfield<0>`, `tracked = bitfield<1>` and
+ * `species = bitfield<2, 3>`, so eight 1-bit fields cost one byte per
+ * element instead of eight `bool` or `int32_t` columns. The word column is an
+ * ordinary column, so merges, sorts and serialization copy it unchanged.
+ * Bits are packed within an element, not across elements: scanning a single
+ * flag still reads one word per element, so it is only cheaper than a `bool`
+ * column when the word is narrower or the flags are tested together.
+ *
+ * `extract` and `deposit` read and write a bit field of a scalar word or of
+ * a batch field (see `get<S>`, `get_wide<S>`), and `flag_mask<T>` turns it
+ * into a xsimd batch_bool of T, ready for `xsimd::select` or masked kernels.
+ */
+template<size_t Offset, size_t Width = 1>
+    requires( Width > 0 and Offset + Width <= 64 )
+struct bitfield {
+    static constexpr size_t offset = Offset;
+    static constexpr size_t width = Width;
+    static constexpr uint64_t low_mask = Width == 64 ? ~uint64_t(0) : (uint64_t(1) << Width) - 1;
+    template<typename W> static constexpr W mask = W(low_mask << Offset);
+};
+
+namespace internal {
+
+template<typename W>
+using lane_word_t = std::conditional_t<(sizeof(W) > 4), uint64_t, uint32_t>;
+
+// Value of lane j of a batch, std::array or scalar.
+template<typename V>
+FORCE_INLINE auto lane(const V& values, size_t j) {
+    if constexpr (requires { values[j]; })
+        return values[j];
+    else if constexpr (requires { values.get(j); })
+        return values.get(j);
+    else
+        return values;
+}
+
+// Values as a batch B of unsigned words, bools as 0 or 1. Batches may be of
+// another architecture than B, e.g. the masks of double lanes.
+template<typename B, typename V>
+FORCE_INLINE B to_lanes(const V& values) {
+    using U = typename B::value_type;
+    if constexpr (requires { typename V::batch_type; })  // batch_bool
+        return xsimd::select(B::batch_bool_type::from_mask(values.mask()), B(1), B(0));
+    else if constexpr (requires { typename V::batch_bool_type; }) {
+        alignas(V::arch_type::alignment()) typename V::value_type buf[V::size];
+        values.store_aligned(buf);
+        return B::load_unaligned(buf);
+    }
+    else if constexpr (requires { values.data(); })
+        return B::load_unaligned(values.data());
+    else
+        return B(U(values));
+}
+
+}  // namespace internal
+
+// Value of the bit field BF of a word, or of each lane of a batch field as a batch of T.
+template<typename BF, typename T = uint32_t, typename F>
+FORCE_INLINE auto extract(const F& field) {
+    if constexpr (std::unsigned_integral<F>)
+        return T((field >> BF::offset) & BF::low_mask);
+    else {
+        using traits = internal::wide_traits<F>;
+        using W = std::remove_cv_t<typename traits::value_type>;
+        constexpr size_t S = traits::lanes;
+        using B = xsimd::make_sized_batch_t<T, S>;
+        const W* words = reinterpret_cast<const W*>(&field);
+        if constexpr (S > 1 and not std::is_void_v<B>)
+            return (B::load_unaligned(words) >> int(BF::offset)) & B(T(BF::low_mask));
+        else {
+            std::array<T, S> result;
+            for (size_t j = 0; j < S; ++j)
+                result[j] = T((words[j] >> BF::offset) & BF::low_mask);
+            return result;
+        }
+    }
+}
+
+// Lanes of a batch field whose bit field BF is non-zero, as a batch_bool of T.
+template<typename T, typename BF, typename F>
+FORCE_INLINE auto flag_mask(const F& field) {
+    using U = internal::lane_word_t<T>;
+    const auto v = extract<BF, U>(field);
+    if constexpr (requires { typename decltype(v)::batch_bool_type; })
+        return xsimd::batch_bool_cast<T>(v != decltype(v)(U(0)));
+    else {
+        std::array<bool, std::tuple_size_v<decltype(v)>> result;
+        for (size_t j = 0; j < result.size(); ++j)
+            result[j] = v[j] != 0;
+        return result;
+    }
+}
+
+/**
+ * Set the bit field BF of a word, or of each lane of a batch field, to the
+ * low bits of `values`: a scalar, a batch, a batch_bool or a std::array.
+ */
+template<typename BF, typename F, typename V>
+FORCE_INLINE void deposit(F& field, const V& values) {
+    if constexpr (std::unsigned_integral<F>) {
+        constexpr F m = BF::template mask<F>;
+        field = F((field & ~m) | ((F(values) << BF::offset) & m));
+    }
+    else {
+        using traits = internal::wide_traits<F>;
+        using W = std::remove_cv_t<typename traits::value_type>;
+        using U = internal::lane_word_t<W>;
+        constexpr size_t S = traits::lanes;
+        using B = xsimd::make_sized_batch_t<U, S>;
+        W* words = reinterpret_cast<W*>(&field);
+        if constexpr (S > 1 and not std::is_void_v<B>) {
+            const B m(U(BF::template mask<W>));
+            const B w = B::load_unaligned(words);
+            const B v = internal::to_lanes<B>(values);
+            ((w & ~m) | ((v << int(BF::offset)) & m)).store_unaligned(words);
+        }
+        else {
+            for (size_t j = 0; j < S; ++j)
+                deposit<BF>(words[j], internal::lane(values, j));
+        }
+    }
+}
+
+}  // namespace aosoa
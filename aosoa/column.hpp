@@ -0,0 +1,110 @@
+#include "predeclarition.hpp"
+#include "algorithm.hpp"
+#include "field.hpp"
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <type_traits>
+
+#pragma once
+
+namespace aosoa {
+
+/**
+ * One scalar column of an AosoaVector: its frames are contiguous, so the
+ * column is the same N-element run repeated every `stride()` bytes. `frame(f)`
+ * gives the run of frame f as a std::span aligned like the container, which
+ * compilers vectorize, and columns never alias, so their `frame_data(f)` can
+ * be passed to kernels as `__restrict` pointers. The element iterators are
+ * for algorithms that do not care about frames.
+ */
+template<typename T, size_t N>
+class StridedColumn {
+    public:
+        using value_type = std::remove_cv_t<T>;
+        using byte_t = std::conditional_t<std::is_const_v<T>, const char, char>;
+        static constexpr size_t frame_size = N;
+
+        class Iter {
+            public:
+                using difference_type = std::ptrdiff_t;
+                using value_type = std::remove_cv_t<T>;
+                using reference = T&;
+                using iterator_category = std::random_access_iterator_tag;
+
+                FORCE_INLINE Iter() = default;
+                FORCE_INLINE Iter(const StridedColumn* column, size_t index) : m_column(column), m_index(index) {}
+
+                FORCE_INLINE T& operator*() const { return (*m_column)[m_index]; }
+                FORCE_INLINE T& operator[](difference_type n) const { return (*m_column)[m_index + n]; }
+
+                FORCE_INLINE Iter& operator++() { ++m_index; return *this; }
+                FORCE_INLINE Iter operator++(int) { auto ret = *this; ++m_index; return ret; }
+                FORCE_INLINE Iter& operator--() { --m_index; return *this; }
+                FORCE_INLINE Iter operator--(int) { auto ret = *this; --m_index; return ret; }
+                FORCE_INLINE Iter& operator+=(difference_type n) { m_index += n; return *this; }
+                FORCE_INLINE Iter& operator-=(difference_type n) { m_index -= n; return *this; }
+                FORCE_INLINE Iter operator+(difference_type n) const { return Iter(m_column, m_index + n); }
+                FORCE_INLINE friend Iter operator+(difference_type n, const Iter& it) { return it + n; }
+                FORCE_INLINE Iter operator-(difference_type n) const { return Iter(m_column, m_index - n); }
+                FORCE_INLINE difference_type operator-(const Iter& other) const { return difference_type(m_index) - difference_type(other.m_index); }
+
+                FORCE_INLINE bool operator==(const Iter& other) const { return m_index == other.m_index; }
+                FORCE_INLINE auto operator<=>(const Iter& other) const { return m_index <=> other.m_index; }
+
+            private:
+                const StridedColumn* m_column = nullptr;
+                size_t m_index = 0;
+        };
+
+        StridedColumn() = default;
+        // `first` is the column in the first frame, `stride` the bytes between frames.
+        StridedColumn(T* first, size_t stride, size_t size) :
+            m_first(reinterpret_cast<byte_t*>(first)), m_stride(stride), m_size(size) {}
+
+        FORCE_INLINE size_t size() const { return m_size; }
+        FORCE_INLINE bool empty() const { return m_size == 0; }
+        FORCE_INLINE size_t stride() const { return m_stride; }
+        FORCE_INLINE size_t num_frames() const { return (m_size + N - 1) / N; }
+
+        FORCE_INLINE T* frame_data(size_t f) const { return reinterpret_cast<T*>(m_first + f * m_stride); }
+        // Elements of frame f, N but in the last frame.
+        FORCE_INLINE std::span<T> frame(size_t f) const { return {frame_data(f), std::min(N, m_size - f * N)}; }
+
+        FORCE_INLINE T& operator[](size_t i) const { return frame_data(i / N)[i % N]; }
+
+        FORCE_INLINE Iter begin() const { return Iter(this, 0); }
+        FORCE_INLINE Iter end() const { return Iter(this, m_size); }
+
+    private:
+        byte_t* m_first = nullptr;
+        size_t m_stride = 0;
+        size_t m_size = 0;
+};
+
+/**
+ * Component K of the field F of a container, see `column<F, K>()`: a std::span
+ * for SoaVector, whose columns are contiguous, and a StridedColumn for
+ * AosoaVector.
+ */
+template<template<typename, size_t> typename F, size_t K, typename C>
+FORCE_INLINE auto make_column(C* c) {
+    using types = typename aosoa_traits<std::remove_cvref_t<C>>::types;
+    constexpr auto loc = internal::locate_field<F>(static_cast<types*>(nullptr));
+    static_assert(loc.second > 0, "no such field in the container");
+    static_assert(K < loc.second, "no such component in the field");
+    constexpr size_t I = loc.first + K;
+    using T = std::remove_pointer_t<decltype(c->template column_data<I>(0))>;
+    if constexpr (internal::is_aosoa<C>) {
+        using Frame = typename std::remove_cvref_t<C>::Frame;
+        if (c->num_frames() == 0)
+            return StridedColumn<T, Frame::size()>();
+        return StridedColumn<T, Frame::size()>(c->template column_data<I>(0), sizeof(Frame), c->size());
+    }
+    else
+        return std::span<T>(c->template column_data<I>(0), c->size());
+}
+
+}  // namespace aosoa
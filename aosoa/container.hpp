@@ -1,5 +1,8 @@
 #include "predeclarition.hpp"
+#include "field.hpp"
 #include "iter.hpp"
+#include "masked.hpp"
+#include "aosoa_iter.hpp"
 #include <xsimd/xsimd.hpp>
 
 #pragma once
@@ -31,6 +34,18 @@ class Container {
         template<size_t S> requires( S <= frame_size )
         FORCE_INLINE auto get(size_t i) const { return derived().get<S>(i); }
 
+        // Batch of S elements starting at i with a register-width batch per scalar type, see `wide_t`.
+        template<size_t S = wide_lanes<types>> requires( S <= frame_size )
+        FORCE_INLINE auto get_wide(size_t i) { return derived().template get_wide<S>(i); }
+        template<size_t S = wide_lanes<types>> requires( S <= frame_size )
+        FORCE_INLINE auto get_wide(size_t i) const { return derived().template get_wide<S>(i); }
+
+        // Batch of S elements starting at any i, with the first `count` (at most S) lanes active.
+        template<size_t S> requires( S > 0 and S <= frame_size )
+        FORCE_INLINE auto get_masked(size_t i, size_t count) { return MaskedRefN<Derived, S, false>(derived_ptr(), i, count); }
+        template<size_t S> requires( S > 0 and S <= frame_size )
+        FORCE_INLINE auto get_masked(size_t i, size_t count) const { return MaskedRefN<Derived, S, true>(derived_ptr(), i, count); }
+
         template<size_t S = 0> requires( S <= frame_size )
         auto begin() { return SoaIter<Derived, S, false>(derived_ptr(), 0); }
         template<size_t S = 0> requires( S <= frame_size )
@@ -71,33 +86,114 @@ class Container {
             return SoaIter<Derived, 1, true>(derived_ptr(), size());
         }
 
+        // Range proxy P over the container d. Views return one over a copy of
+        // themselves instead, see view.hpp.
+        template<typename P, typename D, typename...Args>
+        FORCE_INLINE static P make_range(D* d, Args...args) { return P(d, args...); }
+
         template<size_t S = 0> requires( S <= frame_size ) auto range() {
-            return SoaRangeProxy<Derived, S, false, false>(derived_ptr());
+            return Derived::template make_range<SoaRangeProxy<Derived, S, false, false>>(derived_ptr());
         }
         template<size_t S = 0> requires( S <= frame_size ) auto range() const {
-            return SoaRangeProxy<Derived, S, true, false>(derived_ptr());
+            return Derived::template make_range<SoaRangeProxy<Derived, S, true, false>>(derived_ptr());
         }
 
         template<size_t S = 0> requires( S <= frame_size ) auto urange() {
-            return SoaRangeProxy<Derived, S, false, true>(derived_ptr());
+            return Derived::template make_range<SoaRangeProxy<Derived, S, false, true>>(derived_ptr());
         }
         template<size_t S = 0> requires( S <= frame_size ) auto urange() const {
-            return SoaRangeProxy<Derived, S, true, true>(derived_ptr());
+            return Derived::template make_range<SoaRangeProxy<Derived, S, true, true>>(derived_ptr());
         }
 
         template<size_t S = 0> requires( S <= frame_size ) auto range(size_t start, size_t end) {
-            return RangedSoaRangeProxy<Derived, S, false, false>(derived_ptr(), start, end);
+            return Derived::template make_range<RangedSoaRangeProxy<Derived, S, false, false>>(derived_ptr(), start, end);
         }
         template<size_t S = 0> requires( S <= frame_size ) auto range(size_t start, size_t end) const {
-            return RangedSoaRangeProxy<Derived, S, true, false>(derived_ptr(), start, end);
+            return Derived::template make_range<RangedSoaRangeProxy<Derived, S, true, false>>(derived_ptr(), start, end);
         }
 
         template<size_t S = 0> requires( S <= frame_size ) auto urange(size_t start, size_t end) {
-            return RangedSoaRangeProxy<Derived, S, false, true>(derived_ptr(), start, end);
+            return Derived::template make_range<RangedSoaRangeProxy<Derived, S, false, true>>(derived_ptr(), start, end);
         }
         template<size_t S = 0> requires( S <= frame_size ) auto urange(size_t start, size_t end) const {
-            return RangedSoaRangeProxy<Derived, S, true, true>(derived_ptr(), start, end);
+            return Derived::template make_range<RangedSoaRangeProxy<Derived, S, true, true>>(derived_ptr(), start, end);
+        }
+
+        // Masked ranges cover all elements with S-lane batches, yielding
+        // partial batches for the unaligned head and tail. See MaskedRefN.
+        template<size_t S> requires( S > 0 and S <= frame_size ) auto mrange() {
+            return Derived::template make_range<MaskedRangeProxy<Derived, S, false>>(derived_ptr(), 0, size());
+        }
+        template<size_t S> requires( S > 0 and S <= frame_size ) auto mrange() const {
+            return Derived::template make_range<MaskedRangeProxy<Derived, S, true>>(derived_ptr(), 0, size());
+        }
+
+        template<size_t S> requires( S > 0 and S <= frame_size ) auto mrange(size_t start, size_t end) {
+            return Derived::template make_range<MaskedRangeProxy<Derived, S, false>>(derived_ptr(), start, end);
+        }
+        template<size_t S> requires( S > 0 and S <= frame_size ) auto mrange(size_t start, size_t end) const {
+            return Derived::template make_range<MaskedRangeProxy<Derived, S, true>>(derived_ptr(), start, end);
+        }
+
+        // Wide batches of S elements (by default the lanes of the narrowest
+        // scalar type), e.g. arrays of two batch<double> and of one
+        // batch<int32_t>. The remaining elements are visited by `urange<S>`.
+        // See wide.hpp.
+        template<size_t S = wide_lanes<types>> requires( S > 0 and S <= frame_size ) auto wrange() {
+            return Derived::template make_range<WideRangeProxy<Derived, S, false>>(derived_ptr(), 0, size() / S * S);
+        }
+        template<size_t S = wide_lanes<types>> requires( S > 0 and S <= frame_size ) auto wrange() const {
+            return Derived::template make_range<WideRangeProxy<Derived, S, true>>(derived_ptr(), 0, size() / S * S);
+        }
+
+        template<size_t S = wide_lanes<types>> requires( S > 0 and S <= frame_size ) auto wrange(size_t start, size_t end) {
+            return Derived::template make_range<WideRangeProxy<Derived, S, false>>(derived_ptr(), (start + S-1) / S * S, end / S * S);
+        }
+        template<size_t S = wide_lanes<types>> requires( S > 0 and S <= frame_size ) auto wrange(size_t start, size_t end) const {
+            return Derived::template make_range<WideRangeProxy<Derived, S, true>>(derived_ptr(), (start + S-1) / S * S, end / S * S);
+        }
+
+        /**
+         * Append at the end of a resizable container, which grows
+         * geometrically (see `reserve`). `push_back(e)` copies an element (a
+         * SoaElem or a reference), `push_back<S>(b)` the S elements of a batch
+         * of `get<S>`, as one batch store when the end is a multiple of S, and
+         * `emplace_back()` returns the new, uninitialized element to be filled
+         * in place. None of them zero the new elements first.
+         */
+        template<typename E>
+        FORCE_INLINE void push_back(const E& elem) { emplace_back() = elem; }
+
+        template<size_t S, typename B> requires( S <= frame_size )
+        void push_back(const B& batch) {
+            const size_t i = size();
+            derived().resize_for_overwrite(i + S);
+            if constexpr (frame_size == std::numeric_limits<size_t>::max() or frame_size % S == 0) {
+                if (i % S == 0) {
+                    derived().template get<S>(i) = batch;
+                    return;
+                }
+            }
+            SoaArray<types, S> lanes;
+            lanes.template get<S>(0) = batch;
+            for (size_t k = 0; k < S; ++k)
+                derived()[i + k] = lanes[k];
+        }
+
+        FORCE_INLINE auto emplace_back() {
+            const size_t i = size();
+            derived().resize_for_overwrite(i + 1);
+            return derived()[i];
         }
+
+        // View exposing the fields Fs only, e.g. `auto v = pa.view<pos, vel>();`. See view.hpp.
+        template<template<typename, size_t> typename...Fs> auto view() { return View<Derived, Fs...>(derived_ptr()); }
+        template<template<typename, size_t> typename...Fs> auto view() const { return View<const Derived, Fs...>(derived_ptr()); }
+
+        // Field F of all elements as a lazy expression, e.g.
+        // `pa.col<pos>() += dt * pa.col<vel>()`. See expr.hpp.
+        template<template<typename, size_t> typename F> auto col() { return make_field<F>(derived_ptr()); }
+        template<template<typename, size_t> typename F> auto col() const { return make_field<F>(derived_ptr()); }
 };
 
 template<typename Derived>
@@ -111,14 +207,22 @@ class AosoaContainer : public Container<Derived> {
         static constexpr size_t elem_size = traits::elem_size;
 
         using Base::derived;
+        using Base::derived_ptr;
 
         // Interface methods
         FORCE_INLINE decltype(auto) frame(size_t idx) { return derived().frame(idx); }
         FORCE_INLINE decltype(auto) frame(size_t idx) const { return derived().frame(idx); }
 
+        FORCE_INLINE size_t num_frames() const { return derived().num_frames(); }
+
         FORCE_INLINE void resize(size_t new_size) { derived().resize(new_size); }
         FORCE_INLINE void clear() { derived().clear(); }
 
+        template<size_t I>
+        FORCE_INLINE auto* column_data(size_t idx) { return frame(idx).template column_data<I>(); }
+        template<size_t I>
+        FORCE_INLINE const auto* column_data(size_t idx) const { return frame(idx).template column_data<I>(); }
+
         // Implement Container API
         FORCE_INLINE auto operator[](size_t i) { return frame(i/frame_size)[i%frame_size]; }
         FORCE_INLINE auto operator[](size_t i) const { return frame(i/frame_size)[i%frame_size]; }
@@ -127,6 +231,69 @@ class AosoaContainer : public Container<Derived> {
         FORCE_INLINE auto get(size_t i) { return frame(i/frame_size).template get<S>(i%frame_size); }
         template<size_t S> requires( S <= frame_size )
         FORCE_INLINE auto get(size_t i) const { return frame(i/frame_size).template get<S>(i%frame_size); }
+
+        template<size_t S = wide_lanes<types>> requires( S <= frame_size )
+        FORCE_INLINE auto get_wide(size_t i) { return frame(i/frame_size).template get_wide<S>(i%frame_size); }
+        template<size_t S = wide_lanes<types>> requires( S <= frame_size )
+        FORCE_INLINE auto get_wide(size_t i) const { return frame(i/frame_size).template get_wide<S>(i%frame_size); }
+
+        // Frame-aware iterators, hiding those of Container.
+        template<size_t S = 0> requires( S <= frame_size )
+        auto begin() { return AosoaIter<Derived, S, false>(derived_ptr(), 0); }
+        template<size_t S = 0> requires( S <= frame_size )
+        auto begin() const { return AosoaIter<Derived, S, true>(derived_ptr(), 0); }
+
+        template<size_t S = 0> requires( S <= frame_size )
+        auto end() {
+            auto _size = this->size();
+            if constexpr (S > 0)
+                _size = _size / S * S;
+            return AosoaIter<Derived, S, false>(derived_ptr(), _size);
+        }
+        template<size_t S = 0> requires( S <= frame_size )
+        auto end() const {
+            auto _size = this->size();
+            if constexpr (S > 0)
+                _size = _size / S * S;
+            return AosoaIter<Derived, S, true>(derived_ptr(), _size);
+        }
+
+        template<size_t S = 0> requires( S <= frame_size ) auto ubegin() {
+            auto _size = this->size();
+            if constexpr (S > 0)
+                _size = _size / S * S;
+            return AosoaIter<Derived, 1, false>(derived_ptr(), _size);
+        }
+        template<size_t S = 0> requires( S <= frame_size ) auto ubegin() const {
+            auto _size = this->size();
+            if constexpr (S > 0)
+                _size = _size / S * S;
+            return AosoaIter<Derived, 1, true>(derived_ptr(), _size);
+        }
+
+        template<size_t S = 0> requires( S <= frame_size ) auto uend() {
+            return AosoaIter<Derived, 1, false>(derived_ptr(), this->size());
+        }
+        template<size_t S = 0> requires( S <= frame_size ) auto uend() const {
+            return AosoaIter<Derived, 1, true>(derived_ptr(), this->size());
+        }
+
+        /**
+         * Call `fn(frame, num)` on each used frame in order, `num` being the
+         * number of elements used in that frame (frame_size except the last).
+         */
+        template<typename Fn>
+        void for_each_frame(Fn&& fn) {
+            const size_t nf = num_frames(), _size = this->size();
+            for (size_t i = 0; i < nf; ++i)
+                fn(frame(i), i+1 < nf ? frame_size : _size - i*frame_size);
+        }
+        template<typename Fn>
+        void for_each_frame(Fn&& fn) const {
+            const size_t nf = num_frames(), _size = this->size();
+            for (size_t i = 0; i < nf; ++i)
+                fn(frame(i), i+1 < nf ? frame_size : _size - i*frame_size);
+        }
 };
 
 }  // namespace aosoa
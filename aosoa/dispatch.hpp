@@ -0,0 +1,145 @@
+#include "parallel.hpp"
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <xsimd/xsimd.hpp>
+
+#pragma once
+
+namespace aosoa {
+
+/**
+ * Runtime selection of the SIMD architecture of kernels, following the xsimd
+ * dispatch model: a kernel is a functor with a member template
+ * `template<class Arch> void operator()(Arch, Args...)`, declared in a header,
+ * and explicitly instantiated for every architecture of the list in a
+ * translation unit compiled for it (e.g. with `-mavx2`). The calling
+ * translation unit only needs the baseline architecture; the best
+ * architecture supported by the CPU is chosen once, at the first dispatch.
+ *
+ * Build with AOSOA_RUNTIME_DISPATCH so that frames are aligned for the widest
+ * architecture of `dispatch_archs` (see `default_align`).
+ */
+
+// Lanes of a batch of T on architecture Arch.
+template<typename Arch, typename T>
+inline static constexpr size_t arch_lanes = Arch::alignment() / sizeof(T);
+
+namespace internal {
+
+template<typename Archs> struct arch_count {};
+template<typename...Archs> struct arch_count<xsimd::arch_list<Archs...>> :
+    std::integral_constant<size_t, sizeof...(Archs)> {};
+
+template<size_t I, typename Archs> struct arch_at {};
+template<size_t I, typename A, typename...Archs> struct arch_at<I, xsimd::arch_list<A, Archs...>> :
+    arch_at<I-1, xsimd::arch_list<Archs...>> {};
+template<typename A, typename...Archs> struct arch_at<0, xsimd::arch_list<A, Archs...>> {
+    using type = A;
+};
+
+// Index in Archs of the first architecture the CPU supports.
+template<typename Archs>
+size_t best_arch_index() {
+    static const size_t index = [] {
+        const unsigned best = xsimd::available_architectures().best;
+        size_t result = arch_count<Archs>::value - 1;
+        bool found = false;
+        tpa::constexpr_for<0, arch_count<Archs>::value, 1>([&](auto I) {
+            using A = typename arch_at<decltype(I)::value, Archs>::type;
+            if (not found and A::version() <= best) {
+                result = decltype(I)::value;
+                found = true;
+            }
+        });
+        return result;
+    }();
+    return index;
+}
+
+}  // namespace internal
+
+// The architecture of Archs kernels are dispatched to, as its index in the list.
+template<typename Archs = dispatch_archs>
+size_t dispatched_arch_index() { return internal::best_arch_index<Archs>(); }
+
+/**
+ * Call `kernel(Arch{}, args...)` with the best architecture of Archs
+ * supported by the CPU, returning its result.
+ */
+template<typename Archs = dispatch_archs, typename Kernel, typename...Args>
+decltype(auto) dispatch(Kernel&& kernel, Args&&...args) {
+    using A0 = typename internal::arch_at<0, Archs>::type;
+    using R = decltype(kernel(A0{}, std::forward<Args>(args)...));
+    const size_t chosen = internal::best_arch_index<Archs>();
+    if constexpr (std::is_void_v<R>) {
+        tpa::constexpr_for<0, internal::arch_count<Archs>::value, 1>([&](auto I) {
+            if (decltype(I)::value == chosen)
+                kernel(typename internal::arch_at<decltype(I)::value, Archs>::type{}, std::forward<Args>(args)...);
+        });
+    }
+    else {
+        R result{};
+        tpa::constexpr_for<0, internal::arch_count<Archs>::value, 1>([&](auto I) {
+            if (decltype(I)::value == chosen)
+                result = kernel(typename internal::arch_at<decltype(I)::value, Archs>::type{}, std::forward<Args>(args)...);
+        });
+        return result;
+    }
+}
+
+/**
+ * Parallel loop with a dispatched kernel: `kernel(Arch{}, container, start, end)`
+ * is called on chunks whose boundaries are multiples of the lanes of T on
+ * the chosen architecture (whole frames for Aosoa containers), so the kernel
+ * can iterate `container.range<arch_lanes<Arch, T>>(start, end)` followed by
+ * the tail `urange`.
+ */
+template<typename T, typename Archs = dispatch_archs, typename C, typename Kernel>
+void dispatch_for_chunks(C& container, Kernel&& kernel, ThreadPool& pool = default_thread_pool()) {
+    dispatch<Archs>([&](auto arch) {
+        using A = decltype(arch);
+        constexpr size_t S = arch_lanes<A, T>;
+        static_assert(aosoa_traits<std::remove_cvref_t<C>>::frame_size == std::numeric_limits<size_t>::max()
+                or aosoa_traits<std::remove_cvref_t<C>>::frame_size % S == 0,
+                "frame size must be a multiple of the lanes of every dispatched architecture");
+        parallel_for_chunks<S>(container, [&](size_t start, size_t end) {
+            kernel(arch, container, start, end);
+        }, pool);
+    });
+}
+
+/**
+ * Load a field of a batch (a xsimd batch or a std::array of lanes, see
+ * `get<S>`) as a batch of architecture Arch, and store it back.
+ */
+template<typename Arch, typename F>
+FORCE_INLINE auto load_as(const F& field) {
+    if constexpr (std::is_same_v<F, xsimd::batch<typename F::value_type, Arch>>)
+        return field;
+    else if constexpr (requires { field.data(); }) {
+        using T = std::remove_cvref_t<decltype(field[0])>;
+        return xsimd::batch<T, Arch>::load_unaligned(field.data());
+    }
+    else {
+        using T = typename F::value_type;
+        alignas(F::arch_type::alignment()) T buf[F::size];
+        field.store_aligned(buf);
+        return xsimd::batch<T, Arch>::load_unaligned(buf);
+    }
+}
+
+template<typename F, typename T, typename Arch>
+FORCE_INLINE void store_as(F& field, const xsimd::batch<T, Arch>& b) {
+    if constexpr (std::is_same_v<F, xsimd::batch<T, Arch>>)
+        field = b;
+    else if constexpr (requires { field.data(); })
+        b.store_unaligned(field.data());
+    else {
+        alignas(Arch::alignment()) T buf[xsimd::batch<T, Arch>::size];
+        b.store_aligned(buf);
+        field = F::load_aligned(buf);
+    }
+}
+
+}  // namespace aosoa
@@ -0,0 +1,104 @@
+#include "field.hpp"
+#include "parallel.hpp"
+#include "scan.hpp"
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <xsimd/xsimd.hpp>
+
+#pragma once
+
+namespace aosoa {
+namespace expr {
+
+/**
+ * `dst op= e` on all elements. Nothing is computed until the statement is
+ * passed to `fuse`, alone or together with other statements.
+ */
+template<typename Op, typename C, size_t I0, size_t D, typename E>
+class [[nodiscard("a statement is evaluated by aosoa::fuse")]] Statement {
+    public:
+        using Container = C;
+        using scalar_t = typename Field<C, I0, D>::scalar_t;
+
+        // Lanes of the batches: those of a register, within a frame.
+        static constexpr size_t lanes = [] {
+            constexpr size_t natural = std::max<size_t>(1, simd_width / sizeof(scalar_t));
+            constexpr size_t frame_size = aosoa_traits<C>::frame_size;
+            return frame_size == std::numeric_limits<size_t>::max() ? natural : std::gcd(natural, frame_size);
+        }();
+        static_assert(not std::is_void_v<xsimd::make_sized_batch_t<scalar_t, lanes>>,
+                "the frame size must be a multiple of a SIMD batch of the field type");
+
+        FORCE_INLINE Statement(Field<C, I0, D> dst, E e) : m_dst(dst), m_e(e) {}
+
+        FORCE_INLINE C* container() const { return m_dst.container(); }
+        FORCE_INLINE bool uses_only(const void* c) const { return m_e.uses(c); }
+
+        template<size_t S, typename P>
+        FORCE_INLINE void apply(P& p) const {
+            using B = xsimd::make_sized_batch_t<scalar_t, S>;
+            tpa::constexpr_for<0, D, 1>([&, this](auto I) {
+                constexpr size_t i = decltype(I)::value;
+                const auto v = m_e.template eval<E::dim == 1 ? 0 : i, S>(p);
+                B r;
+                if constexpr (std::is_same_v<Op, Assign>)
+                    r = to_dst<B>(v);
+                else
+                    r = Op{}(m_dst.template eval<i, S>(p), to_dst<B>(v));
+                internal::store_batch(m_dst.template ref<i>(p), r);
+            });
+        }
+
+    private:
+        Field<C, I0, D> m_dst;
+        E m_e;
+
+        template<typename B, typename V>
+        FORCE_INLINE static B to_dst(const V& v) {
+            if constexpr (std::is_arithmetic_v<V>)
+                return B(scalar_t(v));
+            else {
+                static_assert(std::is_same_v<V, B>, "fields of a statement must have the same scalar type");
+                return v;
+            }
+        }
+};
+
+}  // namespace expr
+
+/**
+ * Evaluate the statements in a single pass over their container, e.g.
+ * `fuse(pa.col<vel>() += dt * pa.col<force>(), pa.col<pos>() += dt * pa.col<vel>())`.
+ * On each batch the statements run in order, so a statement sees the results
+ * of the previous ones. All fields must belong to the same container, else
+ * std::invalid_argument is thrown.
+ */
+template<typename...Stmts>
+void fuse(ThreadPool& pool, Stmts&&...stmts) {
+    static_assert(sizeof...(Stmts) > 0);
+    using C = typename std::remove_cvref_t<std::tuple_element_t<0, std::tuple<Stmts...>>>::Container;
+    static_assert((std::is_same_v<typename std::remove_cvref_t<Stmts>::Container, C> and ...),
+            "fused statements must be on the same container");
+    constexpr size_t S = std::min({std::remove_cvref_t<Stmts>::lanes...});
+
+    C* c = std::get<0>(std::forward_as_tuple(stmts...)).container();
+    if (not ((stmts.container() == c and stmts.uses_only(c)) and ...))
+        throw std::invalid_argument("fused statements must be on the same container");
+
+    parallel_for_chunks<S>(*c, [&](size_t start, size_t end) {
+        for (auto p : c->template mrange<S>(start, end))
+            (stmts.template apply<S>(p), ...);
+    }, pool);
+}
+
+template<typename...Stmts>
+    requires( sizeof...(Stmts) > 0 and (not std::is_same_v<std::remove_cvref_t<Stmts>, ThreadPool> and ...) )
+void fuse(Stmts&&...stmts) {
+    fuse(default_thread_pool(), std::forward<Stmts>(stmts)...);
+}
+
+}  // namespace aosoa
@@ -0,0 +1,197 @@
+#include "predeclarition.hpp"
+#include <algorithm>
+#include <concepts>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <xsimd/xsimd.hpp>
+
+#pragma once
+
+namespace aosoa {
+namespace internal {
+
+// A field of a S-lane batch as a xsimd batch: either already one, or the
+// std::array of lanes `get<S>` yields for non-simd components.
+template<size_t S, typename X>
+FORCE_INLINE auto to_batch(const X& x) {
+    if constexpr (requires { x.data(); }) {
+        using T = std::remove_cvref_t<decltype(x[0])>;
+        return xsimd::make_sized_batch_t<T, S>::load_unaligned(x.data());
+    }
+    else
+        return x;
+}
+
+template<template<typename, size_t> typename F, typename T>
+struct is_field : std::false_type {};
+template<template<typename, size_t> typename F, typename T, size_t N>
+struct is_field<F, F<T, N>> : std::true_type {};
+
+// First scalar column and dimension of the field F in Types.
+template<template<typename, size_t> typename F, typename...Ts>
+constexpr std::pair<size_t, size_t> locate_field(std::tuple<Ts...>*) {
+    size_t acc = 0, start = std::numeric_limits<size_t>::max(), dim = 0;
+    ((is_field<F, Ts>::value and dim == 0 ? (start = acc, dim = Ts::dim) : 0, acc += Ts::dim), ...);
+    return {start, dim};
+}
+
+}  // namespace internal
+
+namespace expr {
+
+/**
+ * Lazy whole-container expressions over fields, e.g.
+ * `fuse(pa.col<pos>() += dt * pa.col<vel>())`. Nodes are evaluated component by
+ * component on the masked S-lane batches of the container; a field of
+ * dimension 1 (or a scalar) is broadcast to all components of the others.
+ */
+
+template<typename E>
+concept expression = requires { typename std::remove_cvref_t<E>::expr_tag; };
+
+template<typename E>
+concept operand = expression<E> or std::is_arithmetic_v<std::remove_cvref_t<E>>;
+
+template<typename T>
+struct Scalar {
+    using expr_tag = void;
+    static constexpr size_t dim = 1;
+    T value;
+
+    template<size_t i, size_t S, typename P>
+    FORCE_INLINE T eval(P&) const { return value; }
+    FORCE_INLINE bool uses(const void*) const { return true; }
+};
+
+template<typename Op, typename A, typename B>
+FORCE_INLINE auto apply_op(Op op, const A& a, const B& b) {
+    if constexpr (std::is_arithmetic_v<A> and not std::is_arithmetic_v<B>)
+        return op(B(typename B::value_type(a)), b);
+    else if constexpr (std::is_arithmetic_v<B> and not std::is_arithmetic_v<A>)
+        return op(a, A(typename A::value_type(b)));
+    else
+        return op(a, b);
+}
+
+template<typename Op, typename L, typename R>
+struct Binary {
+    using expr_tag = void;
+    static_assert(L::dim == R::dim or L::dim == 1 or R::dim == 1, "components of operands differ");
+    static constexpr size_t dim = std::max(L::dim, R::dim);
+    L l;
+    R r;
+
+    template<size_t i, size_t S, typename P>
+    FORCE_INLINE auto eval(P& p) const {
+        return apply_op(Op{}, l.template eval<L::dim == 1 ? 0 : i, S>(p), r.template eval<R::dim == 1 ? 0 : i, S>(p));
+    }
+    FORCE_INLINE bool uses(const void* c) const { return l.uses(c) and r.uses(c); }
+};
+
+template<typename Op, typename E>
+struct Unary {
+    using expr_tag = void;
+    static constexpr size_t dim = E::dim;
+    E e;
+
+    template<size_t i, size_t S, typename P>
+    FORCE_INLINE auto eval(P& p) const { return Op{}(e.template eval<i, S>(p)); }
+    FORCE_INLINE bool uses(const void* c) const { return e.uses(c); }
+};
+
+template<typename E>
+FORCE_INLINE auto wrap(const E& e) {
+    if constexpr (expression<E>)
+        return e;
+    else
+        return Scalar<E>{e};
+}
+
+template<typename E>
+using wrap_t = decltype(wrap(std::declval<const E&>()));
+
+template<typename Op, typename C, size_t I0, size_t D, typename E>
+class Statement;
+
+// Field assignment operators.
+struct Assign { template<typename A, typename B> FORCE_INLINE auto operator()(const A&, const B& b) const { return b; } };
+using AddAssign = std::plus<>;
+using SubAssign = std::minus<>;
+using MulAssign = std::multiplies<>;
+using DivAssign = std::divides<>;
+
+/**
+ * The D components of a field of container C, starting at scalar column I0.
+ * Assigning an expression to it gives a Statement.
+ */
+template<typename C, size_t I0, size_t D>
+class Field {
+    public:
+        using expr_tag = void;
+        using Container = C;
+        static constexpr size_t dim = D;
+        using scalar_t = std::remove_cvref_t<decltype(*std::declval<C&>().template column_data<I0>(0))>;
+
+        FORCE_INLINE explicit Field(C* c) : m_c(c) {}
+
+        FORCE_INLINE C* container() const { return m_c; }
+        FORCE_INLINE bool uses(const void* c) const { return c == static_cast<const void*>(m_c); }
+
+        template<size_t i, size_t S, typename P>
+        FORCE_INLINE auto eval(P& p) const {
+            return internal::to_batch<S>(std::get<I0 + i>(p.data()));
+        }
+
+        template<size_t i, typename P>
+        FORCE_INLINE decltype(auto) ref(P& p) const { return std::get<I0 + i>(p.data()); }
+
+        template<operand E> auto operator=(const E& e) const { return make_statement<Assign>(e); }
+        template<operand E> auto operator+=(const E& e) const { return make_statement<AddAssign>(e); }
+        template<operand E> auto operator-=(const E& e) const { return make_statement<SubAssign>(e); }
+        template<operand E> auto operator*=(const E& e) const { return make_statement<MulAssign>(e); }
+        template<operand E> auto operator/=(const E& e) const { return make_statement<DivAssign>(e); }
+
+    private:
+        C* m_c;
+
+        template<typename Op, typename E>
+        auto make_statement(const E& e) const {
+            static_assert(not std::is_const_v<C>, "cannot assign to a field of a const container");
+            static_assert(wrap_t<E>::dim == D or wrap_t<E>::dim == 1, "components of the field and the expression differ");
+            if (not wrap(e).uses(m_c))
+                throw std::invalid_argument("fields of a statement must belong to the same container");
+            return Statement<Op, C, I0, D, wrap_t<E>>(*this, wrap(e));
+        }
+};
+
+template<typename Op, typename L, typename R>
+FORCE_INLINE auto make_binary(const L& l, const R& r) {
+    return Binary<Op, wrap_t<L>, wrap_t<R>>{wrap(l), wrap(r)};
+}
+
+template<operand L, operand R> requires( expression<L> or expression<R> )
+FORCE_INLINE auto operator+(const L& l, const R& r) { return make_binary<std::plus<>>(l, r); }
+template<operand L, operand R> requires( expression<L> or expression<R> )
+FORCE_INLINE auto operator-(const L& l, const R& r) { return make_binary<std::minus<>>(l, r); }
+template<operand L, operand R> requires( expression<L> or expression<R> )
+FORCE_INLINE auto operator*(const L& l, const R& r) { return make_binary<std::multiplies<>>(l, r); }
+template<operand L, operand R> requires( expression<L> or expression<R> )
+FORCE_INLINE auto operator/(const L& l, const R& r) { return make_binary<std::divides<>>(l, r); }
+template<expression E>
+FORCE_INLINE auto operator-(const E& e) { return Unary<std::negate<>, E>{e}; }
+
+}  // namespace expr
+
+template<template<typename, size_t> typename F, typename C>
+FORCE_INLINE auto make_field(C* c) {
+    using types = typename aosoa_traits<std::remove_cvref_t<C>>::types;
+    constexpr auto loc = internal::locate_field<F>(static_cast<types*>(nullptr));
+    static_assert(loc.second > 0, "no such field in the container");
+    return expr::Field<C, loc.first, loc.second>(c);
+}
+
+}  // namespace aosoa
@@ -0,0 +1,136 @@
+#include "predeclarition.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#pragma once
+
+namespace aosoa {
+
+/**
+ * Shared pool of frames for AosoaList, e.g. one `AosoaList<...>::Pool` for
+ * all the per-cell lists of a species. Frames are allocated in slabs of
+ * `slab_frames` contiguous frames and recycled through free lists, so lists
+ * that grow, shrink, merge or deserialize exchange frames instead of calling
+ * malloc, and memory freed by a shrinking list is reused by the others.
+ *
+ * Each thread takes and returns frames through its own shard of the free
+ * lists, refilling an empty one with half the frames of another shard before
+ * allocating a new slab. The pool must outlive the lists using it.
+ */
+template<typename Frame>
+class FramePool {
+    public:
+        explicit FramePool(size_t slab_frames = 64, size_t num_shards = std::max(1u, std::thread::hardware_concurrency())) :
+            m_slab_frames(std::max<size_t>(slab_frames, 1)), m_num_shards(std::max<size_t>(num_shards, 1)),
+            m_shards(std::make_unique<Shard[]>(m_num_shards)) {}
+
+        FramePool(const FramePool&) = delete;
+        FramePool& operator=(const FramePool&) = delete;
+
+        // A frame of unspecified content
+        Frame* acquire() {
+            Shard& own = shard();
+            {
+                std::lock_guard lk(own.mutex);
+                if (not own.free.empty()) {
+                    Frame* frame = own.free.back();
+                    own.free.pop_back();
+                    return frame;
+                }
+            }
+            std::vector<Frame*> frames = steal(own);
+            if (frames.empty())
+                frames = allocate_slab();
+            Frame* frame = frames.back();
+            frames.pop_back();
+            if (not frames.empty()) {
+                std::lock_guard lk(own.mutex);
+                own.free.insert(own.free.end(), frames.begin(), frames.end());
+            }
+            return frame;
+        }
+
+        void release(Frame* frame) {
+            Shard& own = shard();
+            std::lock_guard lk(own.mutex);
+            own.free.push_back(frame);
+        }
+
+        // Frames allocated by the pool, in use or not.
+        size_t capacity() const {
+            std::lock_guard lk(m_slab_mutex);
+            return m_slabs.size() * m_slab_frames;
+        }
+
+        // Frames not in use.
+        size_t num_free() const {
+            size_t num = 0;
+            for (size_t i = 0; i < m_num_shards; ++i) {
+                std::lock_guard lk(m_shards[i].mutex);
+                num += m_shards[i].free.size();
+            }
+            return num;
+        }
+
+    private:
+        struct alignas(64) Shard {
+            mutable std::mutex mutex;
+            std::vector<Frame*> free;
+        };
+
+        size_t m_slab_frames, m_num_shards;
+        std::unique_ptr<Shard[]> m_shards;
+        mutable std::mutex m_slab_mutex;
+        std::vector<std::unique_ptr<Frame[]>> m_slabs;
+
+        Shard& shard() {
+            thread_local const size_t hash = std::hash<std::thread::id>{}(std::this_thread::get_id());
+            return m_shards[hash % m_num_shards];
+        }
+
+        // Half of the free frames of the first other shard having some. Only
+        // one shard is locked at a time.
+        std::vector<Frame*> steal(const Shard& own) {
+            std::vector<Frame*> frames;
+            for (size_t i = 0; i < m_num_shards and frames.empty(); ++i) {
+                Shard& other = m_shards[i];
+                if (&other == &own)
+                    continue;
+                std::lock_guard lk(other.mutex);
+                const size_t num = (other.free.size() + 1) / 2;
+                frames.assign(other.free.end() - num, other.free.end());
+                other.free.resize(other.free.size() - num);
+            }
+            return frames;
+        }
+
+        std::vector<Frame*> allocate_slab() {
+            auto slab = std::make_unique_for_overwrite<Frame[]>(m_slab_frames);
+            std::vector<Frame*> frames(m_slab_frames);
+            for (size_t i = 0; i < m_slab_frames; ++i)
+                frames[m_slab_frames - 1 - i] = &slab[i];
+            std::lock_guard lk(m_slab_mutex);
+            m_slabs.push_back(std::move(slab));
+            return frames;
+        }
+};
+
+// Owner of an AosoaList frame: its pool, or the heap when null.
+template<typename Frame>
+struct FrameDeleter {
+    FramePool<Frame>* pool = nullptr;
+
+    void operator()(Frame* frame) const {
+        if (pool)
+            pool->release(frame);
+        else
+            delete frame;
+    }
+};
+
+}  // namespace aosoa
@@ -0,0 +1,207 @@
+#include "container.hpp"
+#include "soa_array.hpp"
+#include "aosoa_vector.hpp"
+#include "aosoa_list.hpp"
+#include <cstddef>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#pragma once
+
+namespace aosoa {
+
+/**
+ * Frame of a HotCold container: the frames of the same index of its hot and
+ * cold parts, seen as one frame of all fields (hot fields first).
+ */
+template<typename Hot, typename Cold, size_t N, size_t align>
+class SplitFrame {
+    public:
+        using HotFrame = SoaArray<Hot, N, align>;
+        using ColdFrame = SoaArray<Cold, N, align>;
+        using Types = decltype(std::tuple_cat(std::declval<Hot>(), std::declval<Cold>()));
+        using ConstTypes = typename soa::const_types<Types>::type;
+        static constexpr size_t num_hot_columns = soa::num_columns<Hot>;
+
+        SplitFrame() = default;
+        SplitFrame(HotFrame* hot, ColdFrame* cold) : m_hot(hot), m_cold(cold) {}
+
+        static constexpr size_t size() { return N; }
+
+        FORCE_INLINE HotFrame& hot() { return *m_hot; }
+        FORCE_INLINE const HotFrame& hot() const { return *m_hot; }
+        FORCE_INLINE ColdFrame& cold() { return *m_cold; }
+        FORCE_INLINE const ColdFrame& cold() const { return *m_cold; }
+
+        FORCE_INLINE auto operator[](size_t idx) {
+            return soa::SoaRef<Types>(std::tuple_cat(hot()[idx].data(), cold()[idx].data()));
+        }
+        FORCE_INLINE auto operator[](size_t idx) const {
+            return soa::SoaRef<ConstTypes>(std::tuple_cat(hot()[idx].data(), cold()[idx].data()));
+        }
+
+        template<size_t S>
+        FORCE_INLINE auto get(size_t idx) {
+            auto h = hot().template get<S>(idx);
+            auto c = cold().template get<S>(idx);
+            return soa::make_soa_refn<Types, S>(std::tuple_cat(h.data(), c.data()));
+        }
+        template<size_t S>
+        FORCE_INLINE auto get(size_t idx) const {
+            auto h = hot().template get<S>(idx);
+            auto c = cold().template get<S>(idx);
+            return soa::make_soa_refn<ConstTypes, S>(std::tuple_cat(h.data(), c.data()));
+        }
+
+        template<size_t S>
+        FORCE_INLINE auto get_wide(size_t idx) {
+            auto h = hot().template get_wide<S>(idx);
+            auto c = cold().template get_wide<S>(idx);
+            auto ref = std::tuple_cat(h.data(), c.data());
+            return soa::SoaRefNAny<Types, decltype(ref), S>(ref);
+        }
+        template<size_t S>
+        FORCE_INLINE auto get_wide(size_t idx) const {
+            auto h = hot().template get_wide<S>(idx);
+            auto c = cold().template get_wide<S>(idx);
+            auto ref = std::tuple_cat(h.data(), c.data());
+            return soa::SoaRefNAny<ConstTypes, decltype(ref), S>(ref);
+        }
+
+        // Pointer to the I-th scalar column, numbered as in Types.
+        template<size_t I>
+        FORCE_INLINE auto* column_data(size_t = 0) {
+            if constexpr (I < num_hot_columns)
+                return m_hot->template column_data<I>();
+            else
+                return m_cold->template column_data<I - num_hot_columns>();
+        }
+        template<size_t I>
+        FORCE_INLINE const auto* column_data(size_t = 0) const {
+            if constexpr (I < num_hot_columns)
+                return hot().template column_data<I>();
+            else
+                return cold().template column_data<I - num_hot_columns>();
+        }
+
+    private:
+        HotFrame* m_hot = nullptr;
+        ColdFrame* m_cold = nullptr;
+};
+
+/**
+ * Container of the fields Hot + Cold that stores the hot fields in one Aosoa
+ * container and the cold ones in another with the same frame indexing, so
+ * kernels over hot fields only stream hot frames. It is itself an Aosoa
+ * container of all fields, e.g. `HotColdVector<std::tuple<pos<double, 3>,
+ * vel<double, 3>>, std::tuple<id<int64_t>>, 8>` iterates `range<S>()` with
+ * `p.pos()` and `p.id()`, and works with `compact`, `sort_by_key`, etc.
+ *
+ * `hot()` and `cold()` give the parts for kernels touching one side only.
+ * They must be resized through this container, which keeps them in sync.
+ * Serialized data is the hot part followed by the cold part.
+ */
+template<typename Hot, typename Cold, size_t N, size_t align, template<typename, size_t, size_t, bool> typename Part>
+class HotCold : public AosoaContainer<HotCold<Hot, Cold, N, align, Part>> {
+    public:
+        using HotPart = Part<Hot, N, align, false>;
+        using ColdPart = Part<Cold, N, align, false>;
+        using Frame = SplitFrame<Hot, Cold, N, align>;
+        using Base = AosoaContainer<HotCold<Hot, Cold, N, align, Part>>;
+        using Base::frame_size,
+              Base::elem_size;
+
+        HotCold() = default;
+        HotCold(const HotCold& other) : m_hot(other.m_hot), m_cold(other.m_cold) { relink(); }
+        HotCold(HotCold&&) = default;
+        HotCold& operator=(const HotCold& other) {
+            m_hot = other.m_hot;
+            m_cold = other.m_cold;
+            relink();
+            return *this;
+        }
+        HotCold& operator=(HotCold&&) = default;
+
+        // Implement Container API
+        FORCE_INLINE size_t size() const { return m_hot.size(); }
+
+        // Implement AosoaContainer API
+        FORCE_INLINE size_t num_frames() const { return m_hot.num_frames(); }
+        FORCE_INLINE Frame& frame(size_t idx) { return m_frames[idx]; }
+        FORCE_INLINE const Frame& frame(size_t idx) const { return m_frames[idx]; }
+
+        FORCE_INLINE void resize(size_t new_size) {
+            m_hot.resize(new_size);
+            m_cold.resize(new_size);
+            relink();
+        }
+        FORCE_INLINE void resize_for_overwrite(size_t new_size) {
+            m_hot.resize_for_overwrite(new_size);
+            m_cold.resize_for_overwrite(new_size);
+            relink();
+        }
+        FORCE_INLINE void reserve(size_t capacity) {
+            m_hot.reserve(capacity);
+            m_cold.reserve(capacity);
+            relink();
+        }
+        FORCE_INLINE void clear() {
+            m_hot.clear();
+            m_cold.clear();
+            relink();
+        }
+
+        // Other methods
+        FORCE_INLINE HotPart& hot() { return m_hot; }
+        FORCE_INLINE const HotPart& hot() const { return m_hot; }
+        FORCE_INLINE ColdPart& cold() { return m_cold; }
+        FORCE_INLINE const ColdPart& cold() const { return m_cold; }
+
+        FORCE_INLINE bool full() const { return m_hot.full(); }
+
+        size_t serialize_size(size_t start, size_t end) const {
+            return m_hot.serialize_size(start, end) + m_cold.serialize_size(start, end);
+        }
+
+        void* serialize(size_t start, size_t end, void* buf) const {
+            buf = m_hot.serialize(start, end, buf);
+            return m_cold.serialize(start, end, buf);
+        }
+
+        void* deserialize(size_t start, void* buf) {
+            buf = m_hot.deserialize(start, buf);
+            buf = m_cold.deserialize(start, buf);
+            relink();
+            return buf;
+        }
+
+        // Move the elements of `other` from `other_start` to this container from `start`, see AosoaList.
+        void move_merge(size_t start, size_t other_start, HotCold& other)
+            requires( requires(HotPart& a) { a.move_merge(0, 0, a); } ) {
+            m_hot.move_merge(start, other_start, other.m_hot);
+            m_cold.move_merge(start, other_start, other.m_cold);
+            relink();
+            other.relink();
+        }
+
+    private:
+        HotPart m_hot;
+        ColdPart m_cold;
+        std::vector<Frame> m_frames;
+
+        // The parts may have moved their frames.
+        void relink() {
+            m_frames.resize(num_frames());
+            for (size_t f = 0; f < m_frames.size(); ++f)
+                m_frames[f] = Frame(&m_hot.frame(f), &m_cold.frame(f));
+        }
+};
+
+template<typename Hot, typename Cold, size_t N, size_t align = default_align>
+using HotColdVector = HotCold<Hot, Cold, N, align, AosoaVector>;
+
+template<typename Hot, typename Cold, size_t N, size_t align = default_align>
+using HotColdList = HotCold<Hot, Cold, N, align, AosoaList>;
+
+}  // namespace aosoa
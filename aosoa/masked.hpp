@@ -0,0 +1,188 @@
+#include "soa.hpp"
+#include "predeclarition.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <xsimd/xsimd.hpp>
+
+#pragma once
+
+namespace aosoa {
+
+/**
+ * A batch of S elements starting at `idx`, of which only the lanes set in
+ * `bits()` are active. Exposes the same field accessors as `get<S>`. `count`
+ * is at most S.
+ *
+ * Full batches at a multiple of S within a frame refer to the container
+ * directly. Other batches are loaded into an aligned local buffer (inactive
+ * lanes are zero) and the active lanes are written back on destruction,
+ * except aligned batches at the end of an Aosoa container, which lie within
+ * the last frame and are referred to directly. In any case, the values of
+ * inactive lanes are unspecified after the kernel.
+ *
+ * A copy is a view of the same lanes that does not write back, so it must
+ * not outlive the original (e.g. a kernel parameter taken by value).
+ */
+template<typename B, size_t S, bool const_iter>
+class MaskedRefN : public soa::Inherited<soa::access_t<
+        std::conditional_t<const_iter, typename soa::const_types<typename aosoa_traits<B>::types>::type, typename aosoa_traits<B>::types>,
+        MaskedRefN<B, S, const_iter>>> {
+    public:
+        using Base = std::conditional_t<const_iter, const B, B>;
+        using traits = aosoa_traits<B>;
+        using base_types = typename traits::types;
+        using self_types = std::conditional_t<const_iter, typename soa::const_types<base_types>::type, base_types>;
+        using Ref = decltype(std::declval<Base&>().template get<S>(0));
+        using Data = std::remove_cvref_t<decltype(std::declval<Ref&>().data())>;
+        static constexpr size_t buffer_align = std::max(traits::align_bytes, simd_width);
+        using Buffer = typename soa::FrameStorageType<base_types, S, buffer_align, true>::type;
+        static constexpr size_t num_columns = std::tuple_size_v<Buffer>;
+
+        static constexpr size_t size() { return S; }
+
+        FORCE_INLINE MaskedRefN(Base* base, size_t idx, size_t count) :
+            m_base(base), m_idx(idx), m_count(count),
+            m_bits(count >= 64 ? ~uint64_t(0) : (uint64_t(1) << count) - 1),
+            m_buffered(not direct(base, idx, count)),
+            m_data(init_data()) {}
+
+        // Only the lanes set in `bits` (among the first `count`) are active.
+        FORCE_INLINE MaskedRefN(Base* base, size_t idx, size_t count, uint64_t bits) :
+            MaskedRefN(base, idx, count) { m_bits &= bits; }
+
+        FORCE_INLINE MaskedRefN(const MaskedRefN& other) :
+            m_base(other.m_base), m_idx(other.m_idx), m_count(other.m_count),
+            m_bits(other.m_bits), m_buffered(false), m_data(other.m_data) {}
+        MaskedRefN& operator=(const MaskedRefN&) = delete;
+
+        FORCE_INLINE ~MaskedRefN() {
+            if constexpr (not const_iter) {
+                if (m_buffered) [[unlikely]]
+                    store();
+            }
+        }
+
+        FORCE_INLINE auto& data() { return m_data; }
+        FORCE_INLINE const auto& data() const { return m_data; }
+
+        FORCE_INLINE size_t index() const { return m_idx; }
+        FORCE_INLINE size_t count() const { return m_count; }
+        FORCE_INLINE bool full() const { return m_count == S; }
+        FORCE_INLINE uint64_t bits() const { return m_bits; }
+
+        // Mask of active lanes, as the batch_bool of a S-lane batch of T.
+        template<typename T = double>
+        FORCE_INLINE auto mask() const {
+            using batch_t = xsimd::make_sized_batch_t<T, S>;
+            return batch_t::batch_bool_type::from_mask(m_bits);
+        }
+
+    private:
+        Base *m_base;
+        size_t m_idx, m_count;
+        uint64_t m_bits;
+        bool m_buffered;
+        alignas(buffer_align) Buffer m_buf;
+        Data m_data;
+
+        // Whether the lanes are a batch of the container: aligned, within a
+        // frame, and full or ending at the end of an Aosoa container, whose
+        // lanes after the end are unused slots of its last frame.
+        FORCE_INLINE static bool direct(Base* base, size_t idx, size_t count) {
+            assert(count <= S and "a masked batch has at most S lanes");
+            if constexpr (traits::frame_size == std::numeric_limits<size_t>::max())
+                return idx % S == 0 and count == S;
+            else if constexpr (traits::frame_size % S == 0)
+                return idx % S == 0 and (count == S or idx + count == base->size());
+            else
+                return false;
+        }
+
+        FORCE_INLINE Data init_data() {
+            if (not m_buffered) [[likely]]
+                return m_base->template get<S>(m_idx).data();
+            load();
+            return [this]<size_t...I>(std::index_sequence<I...>) {
+                return Data(*reinterpret_cast<std::remove_reference_t<std::tuple_element_t<I, Data>>*>(
+                            std::get<I>(m_buf).data())...);
+            }(std::make_index_sequence<num_columns>{});
+        }
+
+        void load() {
+            m_buf = Buffer{};
+            for (size_t j = 0; j < m_count; ++j) {
+                auto elem = (*m_base)[m_idx + j];
+                tpa::constexpr_for<0, num_columns, 1>([&, this](auto I) {
+                    std::get<I>(m_buf)[j] = std::get<I>(elem.data());
+                });
+            }
+        }
+
+        void store() {
+            for (size_t j = 0; j < m_count; ++j) {
+                auto elem = (*m_base)[m_idx + j];
+                tpa::constexpr_for<0, num_columns, 1>([&, this](auto I) {
+                    std::get<I>(elem.data()) = std::get<I>(m_buf)[j];
+                });
+            }
+        }
+};
+
+/**
+ * Iterate over [start, end) with S-lane batches. Batches are aligned to
+ * multiples of S, the unaligned head and tail are yielded as partial batches.
+ */
+template<typename B, size_t S, bool const_iter>
+class MaskedIter {
+    public:
+        using Base = std::conditional_t<const_iter, const B, B>;
+        using difference_type = std::ptrdiff_t;
+        using value_type = void;
+        using iterator_category = std::forward_iterator_tag;
+        using Self = MaskedIter<B, S, const_iter>;
+
+        FORCE_INLINE MaskedIter() : m_data(nullptr), m_index(0), m_end(0) {}
+        FORCE_INLINE MaskedIter(Base* base, size_t index, size_t end) : m_data(base), m_index(index), m_end(end) {}
+
+        FORCE_INLINE MaskedRefN<B, S, const_iter> operator*() const {
+            return MaskedRefN<B, S, const_iter>(m_data, m_index, next() - m_index);
+        }
+
+        FORCE_INLINE size_t index() const { return m_index; }
+        FORCE_INLINE Base* data() const { return m_data; }
+
+        FORCE_INLINE auto& operator++() { m_index = next(); return *this; }
+        FORCE_INLINE auto operator++(int) { auto ret = *this; m_index = next(); return ret; }
+
+        FORCE_INLINE bool operator==(const Self& other) const { return m_index == other.index(); }
+
+    private:
+        Base *m_data;
+        size_t m_index, m_end;
+
+        FORCE_INLINE size_t next() const {
+            return std::min(m_end, (m_index / S + 1) * S);
+        }
+};
+
+template<typename B, size_t S, bool const_iter>
+    requires( S > 0 )
+class MaskedRangeProxy {
+    public:
+        using Iter = MaskedIter<B, S, const_iter>;
+        using Base = typename Iter::Base;
+        MaskedRangeProxy(Base *data, size_t start, size_t end) :
+            m_data(data), m_start(start), m_end(end) {}
+
+        auto begin() const { return Iter(m_data, m_start, m_end); }
+        auto end() const { return Iter(m_data, m_end, m_end); }
+
+    private:
+        Base *m_data;
+        size_t m_start, m_end;
+};
+
+}  // namespace aosoa
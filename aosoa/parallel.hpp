@@ -0,0 +1,222 @@
+#include "container.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#pragma once
+
+namespace aosoa {
+
+inline static constexpr size_t cache_line_size = 64;
+
+/**
+ * Fixed-size pool of worker threads. `run(num_tasks, fn)` calls `fn(i)` for
+ * every task i, the calling thread taking part, and blocks until all tasks
+ * are done. The first exception thrown by a task is rethrown by `run`.
+ * `run` called from within a task executes the tasks serially.
+ */
+class ThreadPool {
+    public:
+        // num_threads: number of threads running tasks, the caller included.
+        explicit ThreadPool(size_t num_threads = std::max(1u, std::thread::hardware_concurrency())) {
+            m_workers.reserve(num_threads - 1);
+            for (size_t i = 1; i < num_threads; ++i)
+                m_workers.emplace_back([this]() { worker_loop(); });
+        }
+
+        ~ThreadPool() {
+            {
+                std::lock_guard lk(m_mutex);
+                m_stop = true;
+            }
+            m_start_cv.notify_all();
+            for (auto& w : m_workers)
+                w.join();
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        size_t size() const { return m_workers.size() + 1; }
+
+        template<typename Fn>
+        void run(size_t num_tasks, Fn&& fn) {
+            if (num_tasks == 0) return;
+            if (in_task() or m_workers.empty() or num_tasks == 1) {
+                for (size_t i = 0; i < num_tasks; ++i)
+                    fn(i);
+                return;
+            }
+
+            std::lock_guard run_lk(m_run_mutex);
+            {
+                std::unique_lock lk(m_mutex);
+                // workers still leaving the previous run read the job state
+                m_done_cv.wait(lk, [this]() { return m_active == 0; });
+                m_ctx = static_cast<void*>(&fn);
+                m_task = [](void* ctx, size_t i) { (*static_cast<std::remove_reference_t<Fn>*>(ctx))(i); };
+                m_num_tasks = num_tasks;
+                m_next = 0;
+                m_done = 0;
+                m_error = nullptr;
+                ++m_generation;
+            }
+            m_start_cv.notify_all();
+
+            work();
+
+            std::unique_lock lk(m_mutex);
+            m_done_cv.wait(lk, [this]() { return m_done == m_num_tasks; });
+            if (m_error)
+                std::rethrow_exception(m_error);
+        }
+
+    private:
+        std::vector<std::thread> m_workers;
+        std::mutex m_mutex, m_run_mutex;
+        std::condition_variable m_start_cv, m_done_cv;
+        bool m_stop = false;
+        size_t m_generation = 0, m_active = 0;
+
+        // current job
+        void* m_ctx = nullptr;
+        void (*m_task)(void*, size_t) = nullptr;
+        size_t m_num_tasks = 0;
+        std::atomic<size_t> m_next{0}, m_done{0};
+        std::exception_ptr m_error;
+
+        static bool& in_task() {
+            thread_local bool flag = false;
+            return flag;
+        }
+
+        void work() {
+            in_task() = true;
+            size_t i;
+            while ((i = m_next.fetch_add(1)) < m_num_tasks) {
+                try {
+                    m_task(m_ctx, i);
+                }
+                catch (...) {
+                    std::lock_guard lk(m_mutex);
+                    if (not m_error)
+                        m_error = std::current_exception();
+                }
+                if (m_done.fetch_add(1) + 1 == m_num_tasks) {
+                    std::lock_guard lk(m_mutex);
+                    m_done_cv.notify_all();
+                }
+            }
+            in_task() = false;
+        }
+
+        void worker_loop() {
+            size_t seen = 0;
+            while (true) {
+                {
+                    std::unique_lock lk(m_mutex);
+                    m_start_cv.wait(lk, [&, this]() { return m_stop or m_generation != seen; });
+                    if (m_stop) return;
+                    seen = m_generation;
+                    ++m_active;
+                }
+                work();
+                {
+                    std::lock_guard lk(m_mutex);
+                    --m_active;
+                }
+                m_done_cv.notify_all();
+            }
+        }
+};
+
+inline ThreadPool& default_thread_pool() {
+    static ThreadPool pool;
+    return pool;
+}
+
+namespace internal {
+
+// Chunk boundaries are multiples of the grain: whole frames for Aosoa
+// containers, whole cache lines of every column for contiguous ones.
+template<typename C, size_t S>
+constexpr size_t chunk_grain() {
+    using traits = aosoa_traits<std::remove_cvref_t<C>>;
+    if constexpr (std::is_base_of_v<AosoaContainer<std::remove_cvref_t<C>>, std::remove_cvref_t<C>>)
+        return traits::frame_size;
+    else
+        return std::lcm(std::max<size_t>(S, 1), cache_line_size);
+}
+
+// Boundary of chunk k out of num_chunks for `size` elements.
+template<size_t grain>
+FORCE_INLINE size_t chunk_bound(size_t size, size_t k, size_t num_chunks) {
+    const size_t num_grains = (size + grain - 1) / grain;
+    return std::min(size, num_grains * k / num_chunks * grain);
+}
+
+/**
+ * `fn` on the S-batches of [start, end), then on its remaining elements, for
+ * a chunk starting on a frame (or S-batch) boundary. In Aosoa containers
+ * whose frame size is not a multiple of S, S-batches would straddle frames,
+ * so each frame is iterated on its own, its last `frame_size % S` elements
+ * one by one.
+ */
+template<size_t S, typename C, typename Fn>
+FORCE_INLINE void for_each_in(C& container, size_t start, size_t end, Fn& fn) {
+    using traits = aosoa_traits<std::remove_cvref_t<C>>;
+    if constexpr (std::is_base_of_v<AosoaContainer<std::remove_cvref_t<C>>, std::remove_cvref_t<C>>
+            and traits::frame_size % S != 0) {
+        for (size_t i = start; i < end; i += traits::frame_size) {
+            auto& frame = container.frame(i / traits::frame_size);
+            const size_t n = std::min(traits::frame_size, end - i);
+            for (auto p : frame.template range<S>(0, n))
+                fn(p);
+            for (auto p : frame.template urange<S>(0, n))
+                fn(p);
+        }
+    }
+    else {
+        for (auto p : container.template range<S>(start, end))
+            fn(p);
+        for (auto p : container.template urange<S>(start, end))
+            fn(p);
+    }
+}
+
+}  // namespace internal
+
+/**
+ * Call `fn(start, end)` in parallel on disjoint chunks covering the
+ * container. Chunks start on frame boundaries for Aosoa containers, and on
+ * cache line (thus S-batch) boundaries otherwise.
+ */
+template<size_t S, typename C, typename Fn>
+void parallel_for_chunks(C& container, Fn&& fn, ThreadPool& pool = default_thread_pool()) {
+    constexpr size_t grain = internal::chunk_grain<C, S>();
+    const size_t size = container.size();
+    const size_t num_chunks = std::min(pool.size(), (size + grain - 1) / grain);
+    pool.run(num_chunks, [&](size_t k) {
+        fn(internal::chunk_bound<grain>(size, k, num_chunks), internal::chunk_bound<grain>(size, k+1, num_chunks));
+    });
+}
+
+/**
+ * Parallel version of iterating `range<S>()` followed by `urange<S>()`:
+ * `fn` is called on every S-batch, and on single elements of the tail.
+ */
+template<size_t S, typename C, typename Fn>
+    requires( S > 0 )
+void parallel_for_each(C& container, Fn&& fn, ThreadPool& pool = default_thread_pool()) {
+    parallel_for_chunks<S>(container, [&](size_t start, size_t end) {
+        internal::for_each_in<S>(container, start, end, fn);
+    }, pool);
+}
+
+}  // namespace aosoa
@@ -1,6 +1,8 @@
 #include "soa.hpp"
 #include <type_traits>
 #include <limits>
+#include <algorithm>
+#include <utility>
 
 #include <xsimd/xsimd.hpp>
 
@@ -10,6 +12,48 @@ namespace aosoa {
 
 inline static constexpr size_t simd_width = xsimd::simd_type<double>::size*sizeof(double);
 
+// Architectures kernels may be dispatched to at runtime, best first. See dispatch.hpp.
+#if defined(AOSOA_DISPATCH_ARCHS)
+using dispatch_archs = xsimd::arch_list<AOSOA_DISPATCH_ARCHS>;
+#elif XSIMD_WITH_SSE2
+using dispatch_archs = xsimd::arch_list<xsimd::avx512f, xsimd::avx2, xsimd::sse2>;
+#else
+using dispatch_archs = xsimd::arch_list<xsimd::default_arch>;
+#endif
+
+// Default alignment of containers. With runtime dispatch, frames are aligned
+// for the widest dispatched architecture rather than the compiled one.
+#ifdef AOSOA_RUNTIME_DISPATCH
+inline static constexpr size_t default_align = std::max<size_t>(simd_width, dispatch_archs::alignment());
+#else
+inline static constexpr size_t default_align = simd_width;
+#endif
+
+// Lanes of the register-width batch of T, 1 if xsimd has none.
+template<typename T>
+inline static constexpr size_t native_lanes = [] {
+    using simd_t = xsimd::simd_type<std::remove_cv_t<T>>;
+    if constexpr (std::is_same_v<simd_t, std::remove_cv_t<T>>)
+        return size_t(1);
+    else
+        return size_t(simd_t::size);
+}();
+
+// Lanes of mixed-type batches: the largest native_lanes of the scalar types,
+// so that every field is made of whole register-width batches.
+template<typename Types>
+inline static constexpr size_t wide_lanes = []<typename...Ts>(std::tuple<Ts...>*) {
+    return std::max({size_t(1), native_lanes<Ts>...});
+}(static_cast<typename soa::StorageType<Types, 0, soa::ElemElem>::type*>(nullptr));
+
+// S lanes of T as a std::array of S / native_lanes<T> register-width batches
+// (an array of one batch when S is the lanes of T), std::array of scalars if
+// T has no batch or S is not a multiple of its lanes. Field type of `get_wide<S>`.
+template<typename T, size_t S>
+using wide_t = std::conditional_t<(native_lanes<T> > 1 and S % native_lanes<T> == 0),
+        std::array<xsimd::simd_type<std::remove_cv_t<T>>, S / native_lanes<T>>,
+        std::array<T, S>>;
+
 namespace internal {
 template<size_t num> inline static constexpr bool is_pow_2 = (num <= 1) ? true : ( (num%2==0) and is_pow_2<num/2> );
 }
@@ -18,42 +62,67 @@ template<typename Derived> class Container;
 template<typename Derived> class AosoaContainer;
 
 // Soa types
-template<typename Types, size_t N, size_t align = simd_width> class SoaArray;
-template<typename Types, size_t align=simd_width> requires( internal::is_pow_2<align> ) class SoaVector;
+// padded: pad every component array to `align` bytes, see soa::PaddedArray
+template<typename Types, size_t N, size_t align = default_align, bool padded = false> class SoaArray;
+// block: all columns in one allocation, see SoaVector
+template<typename Types, size_t align=default_align, bool block = false> requires( internal::is_pow_2<align> ) class SoaVector;
 
 // Aosoa types
-template<typename Types, size_t N, size_t align = simd_width> class AosoaList;
-template<typename Types, size_t N, size_t align = simd_width> class AosoaVector;
+template<typename Types, size_t N, size_t align = default_align, bool padded = false> class AosoaList;
+template<typename Types, size_t N, size_t align = default_align, bool padded = false> class AosoaVector;
+
+// Hot and cold fields in two parallel Aosoa containers, see hot_cold.hpp
+template<typename Hot, typename Cold, size_t N, size_t align = default_align,
+         template<typename, size_t, size_t, bool> typename Part = AosoaVector> class HotCold;
 
 // Traits
 template<typename T> struct aosoa_traits {};
 
-template<typename Types, size_t N, size_t align> struct aosoa_traits<SoaArray<Types, N, align>> {
+template<typename Types, size_t N, size_t align, bool padded_> struct aosoa_traits<SoaArray<Types, N, align, padded_>> {
     using types = Types;
     static constexpr size_t elem_size = soa::elems_size<Types>::value;
     static constexpr size_t frame_size = N;
     static constexpr size_t align_bytes = align;
+    static constexpr bool padded = padded_;
 };
-template<typename Types, size_t align> struct aosoa_traits<SoaVector<Types, align>> {
+template<typename Types, size_t align, bool block> struct aosoa_traits<SoaVector<Types, align, block>> {
     using types = Types;
     static constexpr size_t elem_size = soa::elems_size<Types>::value;
     static constexpr size_t frame_size = std::numeric_limits<size_t>::max();
     static constexpr size_t align_bytes = align;
+    static constexpr bool padded = false;
 };
 
-template<typename Types, size_t N, size_t align> struct aosoa_traits<AosoaList<Types, N, align>> {
+template<typename Types, size_t N, size_t align, bool padded_> struct aosoa_traits<AosoaList<Types, N, align, padded_>> {
     using types = Types;
     static constexpr size_t frame_size = N;
     static constexpr size_t elem_size = soa::elems_size<Types>::value;
     static constexpr size_t align_bytes = align;
+    static constexpr bool padded = padded_;
 };
-template<typename Types, size_t N, size_t align> struct aosoa_traits<AosoaVector<Types, N, align>> {
+template<typename Types, size_t N, size_t align, bool padded_> struct aosoa_traits<AosoaVector<Types, N, align, padded_>> {
     using types = Types;
     static constexpr size_t frame_size = N;
     static constexpr size_t elem_size = soa::elems_size<Types>::value;
     static constexpr size_t align_bytes = align;
+    static constexpr bool padded = padded_;
 };
 
+template<typename Hot, typename Cold, size_t N, size_t align, template<typename, size_t, size_t, bool> typename Part>
+struct aosoa_traits<HotCold<Hot, Cold, N, align, Part>> {
+    using types = decltype(std::tuple_cat(std::declval<Hot>(), std::declval<Cold>()));
+    static constexpr size_t frame_size = N;
+    static constexpr size_t elem_size = soa::elems_size<Hot>::value + soa::elems_size<Cold>::value;
+    static constexpr size_t align_bytes = align;
+    static constexpr bool padded = false;
+};
+
+// View of some fields of a container, see view.hpp
+template<typename C, template<typename, size_t> typename...Fs> class View;
+
+// Ranges of `get_wide` batches, see wide.hpp
+template<typename B, size_t S, bool const_iter> class WideRangeProxy;
+
 // iter types
 template<typename B, size_t S, bool const_iter=false> class SoaIter;
 template<typename B, size_t S, bool const_iter, bool unaligned> class SoaRangeProxy;
@@ -0,0 +1,213 @@
+#include "predeclarition.hpp"
+#include <array>
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <xsimd/xsimd.hpp>
+
+#pragma once
+
+namespace aosoa {
+
+/**
+ * Reduced-precision scalar types for element fields, e.g.
+ * `weight<aosoa::float16>` or `charge<aosoa::fixed<int16_t, -1., 1.>>`.
+ * They are stored as their encoded bits, so they shrink `elem_size`, and
+ * convert implicitly to and from `value_type` on scalar access. On batch
+ * access `get<S>` yields a std::array of them, which `decode` turns into a
+ * batch of value_type and `encode` writes back.
+ *
+ * Each type decodes from and encodes to batches of its `carrier_type`, the
+ * encoded bits widened to the lane size of value_type.
+ */
+template<typename Q>
+concept quantized = requires {
+    typename Q::value_type;
+    typename Q::storage_type;
+    typename Q::carrier_type;
+} and sizeof(Q) == sizeof(typename Q::storage_type) and std::is_trivially_copyable_v<Q>;
+
+// IEEE 754 binary16, round to nearest even.
+struct float16 {
+    using value_type = float;
+    using storage_type = uint16_t;
+    using carrier_type = uint32_t;
+
+    storage_type bits;
+
+    float16() = default;
+    FORCE_INLINE float16(float x) : bits(storage_type(encode(std::bit_cast<uint32_t>(x)))) {}
+    FORCE_INLINE operator float() const { return std::bit_cast<float>(decode(uint32_t(bits))); }
+
+    // Bits of the float of the half in the low bits of h. Half denormals are
+    // float normals, scaled into place by 2^112.
+    static FORCE_INLINE uint32_t decode(uint32_t h) {
+        const uint32_t em = h & 0x7fff, sign = (h & 0x8000) << 16;
+        if (em >= 0x7c00)
+            return sign | (em << 13) | 0x7f800000;
+        return sign | std::bit_cast<uint32_t>(std::bit_cast<float>(em << 13) * 0x1p112f);
+    }
+    template<typename A>
+    static FORCE_INLINE xsimd::batch<float, A> decode(const xsimd::batch<uint32_t, A>& h) {
+        using u = xsimd::batch<uint32_t, A>;
+        const u em = h & u(0x7fff), sign = (h & u(0x8000)) << 16;
+        const u finite = xsimd::bitwise_cast<uint32_t>(xsimd::bitwise_cast<float>(em << 13) * xsimd::batch<float, A>(0x1p112f));
+        const u o = xsimd::select(em >= u(0x7c00), (em << 13) | u(0x7f800000), finite);
+        return xsimd::bitwise_cast<float>(o | sign);
+    }
+
+    // Half bits of the float bits f: overflow to infinity, NaN to a quiet
+    // NaN, denormals rounded by adding 0.5f.
+    static constexpr uint32_t f16_max = (127 + 16) << 23, f16_min_normal = 113 << 23;
+    static constexpr uint32_t denorm_magic = 126 << 23, f32_inf = 255 << 23;
+    static constexpr uint32_t rebias = uint32_t(15 - 127) << 23;
+
+    static FORCE_INLINE uint32_t encode(uint32_t f) {
+        const uint32_t sign = f & 0x80000000u;
+        f ^= sign;
+        uint32_t o;
+        if (f >= f16_max)
+            o = f > f32_inf ? 0x7e00 : 0x7c00;
+        else if (f < f16_min_normal)
+            o = std::bit_cast<uint32_t>(std::bit_cast<float>(f) + std::bit_cast<float>(denorm_magic)) - denorm_magic;
+        else
+            o = (f + rebias + 0xfff + ((f >> 13) & 1)) >> 13;
+        return o | (sign >> 16);
+    }
+    template<typename A>
+    static FORCE_INLINE xsimd::batch<uint32_t, A> encode(const xsimd::batch<float, A>& x) {
+        using u = xsimd::batch<uint32_t, A>;
+        u f = xsimd::bitwise_cast<uint32_t>(x);
+        const u sign = f & u(0x80000000u);
+        f = f ^ sign;
+        const u big = xsimd::select(f > u(f32_inf), u(0x7e00), u(0x7c00));
+        const u denorm = xsimd::bitwise_cast<uint32_t>(xsimd::bitwise_cast<float>(f) + xsimd::batch<float, A>(0.5f)) - u(denorm_magic);
+        const u normal = (f + u(rebias + 0xfff) + ((f >> 13) & u(1))) >> 13;
+        const u o = xsimd::select(f >= u(f16_max), big, xsimd::select(f < u(f16_min_normal), denorm, normal));
+        return o | (sign >> 16);
+    }
+};
+
+// bfloat16: the upper half of a float, round to nearest even.
+struct bfloat16 {
+    using value_type = float;
+    using storage_type = uint16_t;
+    using carrier_type = uint32_t;
+
+    storage_type bits;
+
+    bfloat16() = default;
+    FORCE_INLINE bfloat16(float x) : bits(storage_type(encode(std::bit_cast<uint32_t>(x)))) {}
+    FORCE_INLINE operator float() const { return std::bit_cast<float>(decode(uint32_t(bits))); }
+
+    static FORCE_INLINE uint32_t decode(uint32_t h) { return h << 16; }
+    template<typename A>
+    static FORCE_INLINE xsimd::batch<float, A> decode(const xsimd::batch<uint32_t, A>& h) {
+        return xsimd::bitwise_cast<float>(h << 16);
+    }
+
+    static FORCE_INLINE uint32_t encode(uint32_t f) {
+        if ((f & 0x7fffffffu) > 0x7f800000u)
+            return (f >> 16) | 0x40;
+        return (f + 0x7fff + ((f >> 16) & 1)) >> 16;
+    }
+    template<typename A>
+    static FORCE_INLINE xsimd::batch<uint32_t, A> encode(const xsimd::batch<float, A>& x) {
+        using u = xsimd::batch<uint32_t, A>;
+        const u f = xsimd::bitwise_cast<uint32_t>(x);
+        return xsimd::select(xsimd::isnan(x), (f >> 16) | u(0x40), (f + u(0x7fff) + ((f >> 16) & u(1))) >> 16);
+    }
+};
+
+/**
+ * Fixed-point value in [lo, hi], stored as an integer I spanning its whole
+ * range, i.e. in steps of (hi-lo) / (max(I)-min(I)); values outside are
+ * clamped. The range is part of the type rather than of the frame, so
+ * elements keep their meaning when copied between frames or containers.
+ */
+template<std::integral I, double lo, double hi, std::floating_point F = float>
+    requires( lo < hi and std::numeric_limits<I>::digits <= std::numeric_limits<F>::digits )
+struct fixed {
+    using value_type = F;
+    using storage_type = I;
+    using carrier_type = F;
+
+    static constexpr F q_min = F(std::numeric_limits<I>::min()), q_max = F(std::numeric_limits<I>::max());
+    static constexpr F step = F((hi - lo) / (double(std::numeric_limits<I>::max()) - double(std::numeric_limits<I>::min())));
+    static constexpr F base = F(lo - double(std::numeric_limits<I>::min()) * double(step));
+
+    storage_type bits;
+
+    fixed() = default;
+    FORCE_INLINE fixed(F x) : bits(storage_type(encode(x))) {}
+    FORCE_INLINE operator F() const { return decode(F(bits)); }
+
+    // V is F or a batch of F
+    template<typename V>
+    static FORCE_INLINE V decode(const V& q) { return q * V(step) + V(base); }
+
+    static FORCE_INLINE F encode(F x) {
+        return std::min(q_max, std::max(q_min, std::nearbyint((x - base) / step)));
+    }
+    template<typename A>
+    static FORCE_INLINE xsimd::batch<F, A> encode(const xsimd::batch<F, A>& x) {
+        using b = xsimd::batch<F, A>;
+        return xsimd::min(b(q_max), xsimd::max(b(q_min), xsimd::nearbyint((x - b(base)) / b(step))));
+    }
+};
+
+namespace internal {
+
+template<typename Q, size_t S>
+inline static constexpr bool has_codec_batch = S > 1
+    and not std::is_void_v<xsimd::make_sized_batch_t<typename Q::value_type, S>>
+    and not std::is_void_v<xsimd::make_sized_batch_t<typename Q::carrier_type, S>>;
+
+}  // namespace internal
+
+/**
+ * Decode a batch field of quantized type Q (see `get<S>`) to a xsimd batch of
+ * Q::value_type, or a std::array of values when S lanes have no batch.
+ */
+template<typename Qc, size_t S>
+    requires( quantized<std::remove_const_t<Qc>> )
+FORCE_INLINE auto decode(const std::array<Qc, S>& field) {
+    using Q = std::remove_const_t<Qc>;
+    using V = typename Q::value_type;
+    if constexpr (internal::has_codec_batch<Q, S>) {
+        using carrier_t = xsimd::make_sized_batch_t<typename Q::carrier_type, S>;
+        const auto* bits = reinterpret_cast<const typename Q::storage_type*>(field.data());
+        return xsimd::make_sized_batch_t<V, S>(Q::decode(carrier_t::load_unaligned(bits)));
+    }
+    else {
+        std::array<V, S> result;
+        for (size_t j = 0; j < S; ++j)
+            result[j] = V(field[j]);
+        return result;
+    }
+}
+
+// Encode a batch of values, a std::array of values or a single value into a batch field.
+template<quantized Q, size_t S, typename B>
+FORCE_INLINE void encode(std::array<Q, S>& field, const B& values) {
+    using V = typename Q::value_type;
+    if constexpr (internal::has_codec_batch<Q, S> and not requires { values.begin(); }) {
+        using value_t = xsimd::make_sized_batch_t<V, S>;
+        auto* bits = reinterpret_cast<typename Q::storage_type*>(field.data());
+        Q::encode(value_t(values)).store_unaligned(bits);
+    }
+    else if constexpr (requires { values[0]; }) {
+        for (size_t j = 0; j < S; ++j)
+            field[j] = Q(V(values[j]));
+    }
+    else {
+        const Q q(static_cast<V>(values));
+        field.fill(q);
+    }
+}
+
+}  // namespace aosoa
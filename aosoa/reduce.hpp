@@ -0,0 +1,256 @@
+#include "field.hpp"
+#include "parallel.hpp"
+#include "masked.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <xsimd/xsimd.hpp>
+
+#pragma once
+
+namespace aosoa {
+
+enum class ReduceMode {
+    fast,           // one partial result per thread
+    deterministic   // fixed blocks combined pairwise, independent of the number of threads
+};
+
+namespace internal {
+
+// Elements per block of deterministic reductions, rounded up to the chunk grain.
+inline static constexpr size_t reduce_block_elems = 2048;
+
+template<typename T> struct is_std_tuple : std::false_type {};
+template<typename...Ts> struct is_std_tuple<std::tuple<Ts...>> : std::true_type {};
+
+// Components of a kernel result, a single field or a std::tuple of them.
+template<size_t S, typename R>
+FORCE_INLINE auto components(const R& r) {
+    if constexpr (is_std_tuple<std::remove_cvref_t<R>>::value)
+        return std::apply([](const auto&...x) { return std::array{to_batch<S>(x)...}; }, r);
+    else
+        return std::array{to_batch<S>(r)};
+}
+
+template<size_t S, typename C, typename Fn>
+using result_components_t = decltype(components<S>(std::declval<Fn&>()(
+                *std::declval<const C&>().template mrange<S>().begin())));
+
+template<size_t S, typename C, typename Fn>
+inline static constexpr bool result_is_tuple = is_std_tuple<std::remove_cvref_t<decltype(std::declval<Fn&>()(
+                *std::declval<const C&>().template mrange<S>().begin()))>>::value;
+
+/**
+ * Call `fn(start, end)` on consecutive ranges covering the container and
+ * return the results in order. The ranges are per-thread chunks, or in
+ * deterministic mode fixed blocks that only depend on the container type.
+ */
+template<size_t S, typename R, typename C, typename Fn>
+std::vector<R> map_blocks(const C& c, Fn&& fn, ReduceMode mode, ThreadPool& pool) {
+    constexpr size_t grain = chunk_grain<C, S>();
+    const size_t size = c.size(), num_grains = (size + grain - 1) / grain;
+    std::vector<R> out;
+    if (mode == ReduceMode::deterministic) {
+        constexpr size_t block = (reduce_block_elems + grain - 1) / grain * grain;
+        out.resize((size + block - 1) / block);
+        pool.run(out.size(), [&](size_t k) {
+            out[k] = fn(k * block, std::min(size, (k+1) * block));
+        });
+    }
+    else {
+        out.resize(std::min(pool.size(), num_grains));
+        pool.run(out.size(), [&](size_t k) {
+            out[k] = fn(chunk_bound<grain>(size, k, out.size()), chunk_bound<grain>(size, k+1, out.size()));
+        });
+    }
+    return out;
+}
+
+// Combine partial results pairwise, in an order only depending on their number.
+template<typename R, typename Op>
+R combine_pairwise(std::vector<R>& parts, R identity, Op&& op) {
+    const size_t n = parts.size();
+    if (n == 0) return identity;
+    for (size_t w = 1; w < n; w *= 2)
+        for (size_t i = 0; i + w < n; i += 2*w)
+            parts[i] = op(parts[i], parts[i+w]);
+    return parts[0];
+}
+
+template<typename T, size_t D>
+FORCE_INLINE std::array<T, D> apply_each(const std::array<T, D>& a, const std::array<T, D>& b, auto&& op) {
+    std::array<T, D> r;
+    for (size_t i = 0; i < D; ++i)
+        r[i] = op(a[i], b[i]);
+    return r;
+}
+
+template<bool tuple_result, typename T, size_t D>
+FORCE_INLINE auto unwrap(const std::array<T, D>& r) {
+    if constexpr (tuple_result)
+        return r;
+    else
+        return r[0];
+}
+
+}  // namespace internal
+
+/**
+ * Sum of `fn` over all elements, e.g. `reduce<S>(pa, [](auto p) { return p.vel(); })`
+ * for the total momentum. `fn` is called on masked S-lane batches (see
+ * `mrange<S>()`), and returns a field or an expression of batches, or a
+ * std::tuple of them; the result is a scalar or a std::array of the
+ * per-component sums. Batches are accumulated lane-wise, inactive lanes
+ * masked out, and the partial sums of the threads are added pairwise.
+ */
+template<size_t S, typename C, typename Fn>
+    requires( S > 0 and S <= 64 )
+auto reduce(const C& c, Fn&& fn, ReduceMode mode = ReduceMode::fast, ThreadPool& pool = default_thread_pool()) {
+    using Comps = internal::result_components_t<S, C, Fn>;
+    using B = typename Comps::value_type;
+    using T = typename B::value_type;
+    constexpr size_t D = std::tuple_size_v<Comps>;
+    using R = std::array<T, D>;
+
+    auto parts = internal::map_blocks<S, R>(c, [&](size_t start, size_t end) {
+        std::array<B, D> acc;
+        acc.fill(B(T(0)));
+        for (auto p : c.template mrange<S>(start, end)) {
+            const auto v = internal::components<S>(fn(p));
+            if (p.full()) [[likely]] {
+                for (size_t i = 0; i < D; ++i)
+                    acc[i] += v[i];
+            }
+            else {
+                const auto m = p.template mask<T>();
+                for (size_t i = 0; i < D; ++i)
+                    acc[i] += xsimd::select(m, v[i], B(T(0)));
+            }
+        }
+        R r;
+        for (size_t i = 0; i < D; ++i)
+            r[i] = xsimd::reduce_add(acc[i]);
+        return r;
+    }, mode, pool);
+
+    R zero;
+    zero.fill(T(0));
+    auto sum = internal::combine_pairwise(parts, zero, [](const R& a, const R& b) {
+        return internal::apply_each(a, b, [](T x, T y) { return x + y; });
+    });
+    return internal::unwrap<internal::result_is_tuple<S, C, Fn>>(sum);
+}
+
+/**
+ * Sum over all elements of the dot product of the fields given by `fa` and
+ * `fb`, e.g. `dot<S>(pa, [](auto p) { return p.vel(); }, [](auto p) { return p.vel(); })`.
+ */
+template<size_t S, typename C, typename FnA, typename FnB>
+    requires( S > 0 and S <= 64 )
+auto dot(const C& c, FnA&& fa, FnB&& fb, ReduceMode mode = ReduceMode::fast, ThreadPool& pool = default_thread_pool()) {
+    return reduce<S>(c, [&](auto p) {
+        const auto a = internal::components<S>(fa(p));
+        const auto b = internal::components<S>(fb(p));
+        static_assert(std::tuple_size_v<decltype(a)> == std::tuple_size_v<decltype(b)>, "fields of dot must have the same dimension");
+        auto s = a[0] * b[0];
+        for (size_t i = 1; i < a.size(); ++i)
+            s += a[i] * b[i];
+        return s;
+    }, mode, pool);
+}
+
+/**
+ * Minimum and maximum of `fn` over all elements, per component, e.g. the
+ * bounding box `minmax<S>(pa, [](auto p) { return p.pos(); })`. Returns a
+ * pair (min, max) of scalars or std::arrays, like `reduce`. Empty containers
+ * give (max, lowest) of the scalar type.
+ */
+template<size_t S, typename C, typename Fn>
+    requires( S > 0 and S <= 64 )
+auto minmax(const C& c, Fn&& fn, ThreadPool& pool = default_thread_pool()) {
+    using Comps = internal::result_components_t<S, C, Fn>;
+    using B = typename Comps::value_type;
+    using T = typename B::value_type;
+    constexpr size_t D = std::tuple_size_v<Comps>;
+    using R = std::pair<std::array<T, D>, std::array<T, D>>;
+    constexpr T lo_init = std::numeric_limits<T>::max(), hi_init = std::numeric_limits<T>::lowest();
+
+    auto parts = internal::map_blocks<S, R>(c, [&](size_t start, size_t end) {
+        std::array<B, D> lo, hi;
+        lo.fill(B(lo_init));
+        hi.fill(B(hi_init));
+        for (auto p : c.template mrange<S>(start, end)) {
+            const auto v = internal::components<S>(fn(p));
+            const auto m = p.template mask<T>();
+            for (size_t i = 0; i < D; ++i) {
+                lo[i] = xsimd::min(lo[i], xsimd::select(m, v[i], B(lo_init)));
+                hi[i] = xsimd::max(hi[i], xsimd::select(m, v[i], B(hi_init)));
+            }
+        }
+        R r;
+        for (size_t i = 0; i < D; ++i) {
+            r.first[i] = xsimd::reduce_min(lo[i]);
+            r.second[i] = xsimd::reduce_max(hi[i]);
+        }
+        return r;
+    }, ReduceMode::fast, pool);
+
+    R init;
+    init.first.fill(lo_init);
+    init.second.fill(hi_init);
+    auto r = internal::combine_pairwise(parts, init, [](const R& a, const R& b) {
+        return R(internal::apply_each(a.first, b.first, [](T x, T y) { return std::min(x, y); }),
+                 internal::apply_each(a.second, b.second, [](T x, T y) { return std::max(x, y); }));
+    });
+    constexpr bool tuple_result = internal::result_is_tuple<S, C, Fn>;
+    return std::pair(internal::unwrap<tuple_result>(r.first), internal::unwrap<tuple_result>(r.second));
+}
+
+/**
+ * Counts of the values of the scalar field `fn` in `num_bins` equal bins
+ * over [lo, hi), values outside being ignored. The bin indices and the range
+ * mask are computed on batches, the counts are incremented lane by lane in
+ * per-thread histograms.
+ */
+template<size_t S, typename C, typename Fn>
+    requires( S > 0 and S <= 64 )
+std::vector<size_t> histogram(const C& c, Fn&& fn, double lo, double hi, size_t num_bins,
+        ThreadPool& pool = default_thread_pool()) {
+    using Comps = internal::result_components_t<S, C, Fn>;
+    using B = typename Comps::value_type;
+    using T = typename B::value_type;
+    static_assert(std::tuple_size_v<Comps> == 1, "histogram requires a scalar field");
+    static_assert(std::is_floating_point_v<T>, "histogram requires a floating point field");
+    const T scale = T(num_bins / (hi - lo));
+
+    auto parts = internal::map_blocks<S, std::vector<size_t>>(c, [&](size_t start, size_t end) {
+        std::vector<size_t> counts(num_bins, 0);
+        alignas(B::arch_type::alignment()) std::array<T, S> bins;
+        for (auto p : c.template mrange<S>(start, end)) {
+            const B x = internal::components<S>(fn(p))[0];
+            const auto in_range = (x >= B(T(lo))) & (x < B(T(hi)));
+            uint64_t bits = p.bits() & uint64_t(in_range.mask());
+            xsimd::floor((x - B(T(lo))) * B(scale)).store_aligned(bins.data());
+            while (bits) {
+                const size_t j = std::countr_zero(bits);
+                ++counts[std::min(num_bins - 1, size_t(bins[j]))];
+                bits &= bits - 1;
+            }
+        }
+        return counts;
+    }, ReduceMode::fast, pool);
+
+    std::vector<size_t> result(num_bins, 0);
+    for (const auto& counts : parts)
+        for (size_t b = 0; b < num_bins; ++b)
+            result[b] += counts[b];
+    return result;
+}
+
+}  // namespace aosoa
@@ -0,0 +1,299 @@
+#include "sort.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <xsimd/xsimd.hpp>
+
+#pragma once
+
+namespace aosoa {
+
+enum class Curve {
+    morton,     // Z-order, bit interleaving
+    hilbert     // continuous, better locality at frame boundaries
+};
+
+// Axis-aligned box mapped to the key space of a curve.
+template<size_t D>
+struct Bounds {
+    std::array<double, D> lo, hi;
+};
+
+// Bits per axis of the 64 bits keys of a D dimensional curve.
+template<size_t D> requires( D >= 1 and D <= 3 )
+inline static constexpr size_t curve_bits = D == 1 ? 63 : (D == 2 ? 31 : 21);
+
+namespace internal {
+
+// Spread the lowest curve_bits<D> bits of x, D-1 zero bits between two of
+// them. V is uint64_t or a xsimd batch of it.
+template<size_t D, typename V>
+FORCE_INLINE V spread_bits(V x) {
+    if constexpr (D == 1)
+        return x;
+    else if constexpr (D == 2) {
+        x = x & V(0x00000000ffffffffull);
+        x = (x | (x << 16)) & V(0x0000ffff0000ffffull);
+        x = (x | (x << 8))  & V(0x00ff00ff00ff00ffull);
+        x = (x | (x << 4))  & V(0x0f0f0f0f0f0f0f0full);
+        x = (x | (x << 2))  & V(0x3333333333333333ull);
+        x = (x | (x << 1))  & V(0x5555555555555555ull);
+        return x;
+    }
+    else {
+        x = x & V(0x00000000001fffffull);
+        x = (x | (x << 32)) & V(0x001f00000000ffffull);
+        x = (x | (x << 16)) & V(0x001f0000ff0000ffull);
+        x = (x | (x << 8))  & V(0x100f00f00f00f00full);
+        x = (x | (x << 4))  & V(0x10c30c30c30c30c3ull);
+        x = (x | (x << 2))  & V(0x1249249249249249ull);
+        return x;
+    }
+}
+
+template<size_t D, typename V>
+FORCE_INLINE V interleave(const std::array<V, D>& q) {
+    V key = spread_bits<D>(q[0]) << int(D - 1);
+    for (size_t i = 1; i < D; ++i)
+        key = key | (spread_bits<D>(q[i]) << int(D - 1 - i));
+    return key;
+}
+
+}  // namespace internal
+
+/**
+ * Morton key of the quantized coordinates `q`, each below
+ * 2^curve_bits<D>. V is uint64_t or a xsimd batch of it.
+ */
+template<size_t D, typename V>
+FORCE_INLINE V morton_key(const std::array<V, D>& q) {
+    return internal::interleave<D>(q);
+}
+
+/**
+ * Hilbert key of the quantized coordinates `q`, each below
+ * 2^curve_bits<D>. The coordinates are transformed to the transposed Hilbert
+ * index (Skilling, 2004), then interleaved. Branches are replaced by bit
+ * masks, so V may be uint64_t or a xsimd batch of it.
+ */
+template<size_t D, typename V>
+FORCE_INLINE V hilbert_key(std::array<V, D> x) {
+    constexpr int bits = curve_bits<D>;
+    if constexpr (D == 1)
+        return x[0];
+    else {
+        // inverse undo
+        for (int b = bits - 1; b > 0; --b) {
+            const V p = V((uint64_t(1) << b) - 1);
+            for (size_t i = 0; i < D; ++i) {
+                const V set = V(0) - ((x[i] >> b) & V(1));
+                const V t = (x[0] ^ x[i]) & p & ~set;
+                x[0] = x[0] ^ (p & set) ^ t;
+                if (i > 0)
+                    x[i] = x[i] ^ t;
+            }
+        }
+        // gray encode
+        for (size_t i = 1; i < D; ++i)
+            x[i] = x[i] ^ x[i-1];
+        V t = V(0);
+        for (int b = bits - 1; b > 0; --b)
+            t = t ^ (((V(0) - ((x[D-1] >> b) & V(1)))) & V((uint64_t(1) << b) - 1));
+        for (size_t i = 0; i < D; ++i)
+            x[i] = x[i] ^ t;
+        return internal::interleave<D>(x);
+    }
+}
+
+namespace internal {
+
+template<size_t D>
+struct CurveMap {
+    std::array<double, D> lo, scale;
+    Curve curve;
+
+    static constexpr double max_q = double((uint64_t(1) << curve_bits<D>) - 1);
+
+    CurveMap(const Bounds<D>& b, Curve curve) : lo(b.lo), curve(curve) {
+        for (size_t i = 0; i < D; ++i)
+            scale[i] = b.hi[i] > b.lo[i] ? (max_q + 1) / (b.hi[i] - b.lo[i]) : 0;
+    }
+
+    // F is double or a batch of double, positions outside the box are clamped.
+    template<typename F, typename V>
+    FORCE_INLINE V key(const std::array<F, D>& pos) const {
+        std::array<V, D> q;
+        for (size_t i = 0; i < D; ++i) {
+            if constexpr (std::is_same_v<F, double>)
+                q[i] = V(std::clamp((pos[i] - lo[i]) * scale[i], 0., max_q));
+            else
+                q[i] = xsimd::batch_cast<uint64_t>(xsimd::min(xsimd::max((pos[i] - F(lo[i])) * F(scale[i]), F(0.)), F(max_q)));
+        }
+        return curve == Curve::hilbert ? hilbert_key<D>(q) : morton_key<D>(q);
+    }
+};
+
+template<typename Tp>
+inline static constexpr size_t pos_dim = std::tuple_size_v<std::remove_cvref_t<Tp>>;
+
+template<typename Tp>
+using pos_scalar_t = std::remove_cvref_t<std::tuple_element_t<0, std::remove_cvref_t<Tp>>>;
+
+/**
+ * Curve keys of all elements of c. Full S-batches whose positions are
+ * doubles are quantized and encoded in SIMD, the others one by one.
+ */
+template<size_t S, size_t D, typename C, typename PosFn>
+std::vector<uint64_t> curve_keys(const C& c, PosFn& pos_fn, const CurveMap<D>& map, ThreadPool& pool) {
+    using Scalar = pos_scalar_t<decltype(pos_fn(c[0]))>;
+    using dbatch = xsimd::make_sized_batch_t<double, S>;
+    using ubatch = xsimd::make_sized_batch_t<uint64_t, S>;
+    constexpr bool simd = S > 1 and std::is_same_v<Scalar, double>
+        and not std::is_void_v<dbatch> and not std::is_void_v<ubatch>;
+
+    std::vector<uint64_t> keys(c.size());
+    auto scalar_key = [&](size_t k) {
+        auto p = pos_fn(c[k]);
+        std::array<double, D> x;
+        tpa::constexpr_for<0, D, 1>([&](auto I) { x[I] = double(std::get<I>(p)); });
+        keys[k] = map.template key<double, uint64_t>(x);
+    };
+
+    // Batches start on multiples of S within a frame and do not cross it,
+    // so chunk heads and frame ends that are not whole batches go one by one.
+    constexpr size_t frame_size = aosoa_traits<std::remove_cvref_t<C>>::frame_size;
+    parallel_for_chunks<S>(c, [&](size_t start, size_t end) {
+        for (size_t k = start; k < end;) {
+            if constexpr (simd) {
+                const size_t offset = k % frame_size;
+                if (offset % S == 0 and offset + S <= frame_size and k + S <= end) {
+                    auto p = pos_fn(c.template get<S>(k));
+                    std::array<dbatch, D> x;
+                    tpa::constexpr_for<0, D, 1>([&](auto I) {
+                        const auto& v = std::get<I>(p);
+                        if constexpr (requires { v.data(); })
+                            x[I] = dbatch::load_unaligned(v.data());
+                        else
+                            x[I] = v;
+                    });
+                    map.template key<dbatch, ubatch>(x).store_unaligned(&keys[k]);
+                    k += S;
+                    continue;
+                }
+            }
+            scalar_key(k++);
+        }
+    }, pool);
+    return keys;
+}
+
+/**
+ * Move the elements at `src[j]` to `dst[j]` for all j, column by column
+ * through a buffer. Elements that are not listed are left untouched.
+ */
+template<typename C>
+void gather_selected(C& c, const std::vector<size_t>& dst, const std::vector<size_t>& src, ThreadPool& pool) {
+    constexpr size_t capacity = segment_capacity<C>;
+    const size_t n = dst.size(), nc = num_chunks(n, pool);
+    for_each_column<C>([&](auto I) {
+        constexpr size_t i = decltype(I)::value;
+        using T = column_t<C, i>;
+        const auto segs = column_segments<i>(c);
+        std::unique_ptr<T[]> tmp(new T[n]);
+        pool.run(nc, [&](size_t t) {
+            for (size_t j = chunk_begin(n, t, nc), e = chunk_begin(n, t+1, nc); j < e; ++j)
+                tmp[j] = segs[src[j] / capacity][src[j] % capacity];
+        });
+        pool.run(nc, [&](size_t t) {
+            for (size_t j = chunk_begin(n, t, nc), e = chunk_begin(n, t+1, nc); j < e; ++j)
+                segs[dst[j] / capacity][dst[j] % capacity] = tmp[j];
+        });
+    });
+}
+
+}  // namespace internal
+
+/**
+ * Reorder the elements along a space-filling curve through their positions,
+ * e.g. `reorder(pa, [](auto p) { return p.pos(); }, bounds)`, so that
+ * neighbouring elements are close in memory. `pos_fn` returns the tuple of
+ * the D coordinates of its argument, a single element or a S-lane batch.
+ * The keys are computed in SIMD, radix sorted, and the permutation is
+ * applied column-wise.
+ */
+template<size_t S = simd_width / sizeof(double), typename C, typename PosFn, size_t D>
+void reorder(C& c, PosFn&& pos_fn, const Bounds<D>& bounds, Curve curve = Curve::hilbert,
+        ThreadPool& pool = default_thread_pool()) {
+    static_assert(internal::pos_dim<decltype(pos_fn(std::as_const(c)[0]))> == D, "dimension of bounds and positions differ");
+    const size_t n = c.size();
+    if (n < 2) return;
+
+    auto keys = internal::curve_keys<S>(std::as_const(c), pos_fn, internal::CurveMap<D>(bounds, curve), pool);
+    std::vector<size_t> perm(n);
+    for (size_t k = 0; k < n; ++k)
+        perm[k] = k;
+    internal::radix_sort(keys, perm, pool);
+    internal::gather_columns(c, perm, pool);
+}
+
+/**
+ * Incremental version of `reorder` for Aosoa containers that are already
+ * mostly in curve order. Only the frames whose key range exceeds
+ * `max_spread` times the average key range of a frame are re-sorted: their
+ * elements are sorted together and put back into the slots of these frames.
+ * The other frames are not touched. Returns the number of re-sorted frames.
+ */
+template<size_t S = simd_width / sizeof(double), typename C, typename PosFn, size_t D>
+size_t reorder_incremental(C& c, PosFn&& pos_fn, const Bounds<D>& bounds, double max_spread = 4.,
+        Curve curve = Curve::hilbert, ThreadPool& pool = default_thread_pool()) {
+    static_assert(internal::is_aosoa<C>, "reorder_incremental requires an AosoaVector or AosoaList");
+    static_assert(internal::pos_dim<decltype(pos_fn(std::as_const(c)[0]))> == D, "dimension of bounds and positions differ");
+    constexpr size_t frame_size = aosoa_traits<C>::frame_size;
+    const size_t n = c.size(), nf = c.num_frames();
+    if (nf < 2) {
+        reorder<S>(c, pos_fn, bounds, curve, pool);
+        return nf;
+    }
+
+    const auto keys = internal::curve_keys<S>(std::as_const(c), pos_fn, internal::CurveMap<D>(bounds, curve), pool);
+    std::vector<uint64_t> lo(nf), hi(nf);
+    const size_t nc = internal::num_chunks(n, pool);
+    pool.run(nc, [&](size_t t) {
+        for (size_t f = internal::chunk_begin(nf, t, nc), e = internal::chunk_begin(nf, t+1, nc); f < e; ++f) {
+            const auto [mn, mx] = std::minmax_element(keys.begin() + f * frame_size,
+                    keys.begin() + std::min(n, (f+1) * frame_size));
+            lo[f] = *mn;
+            hi[f] = *mx;
+        }
+    });
+    const uint64_t all_lo = *std::min_element(lo.begin(), lo.end()),
+                   all_hi = *std::max_element(hi.begin(), hi.end());
+    const double limit = max_spread * double(all_hi - all_lo) / nf;
+
+    std::vector<size_t> slots;
+    std::vector<uint64_t> dirty_keys;
+    size_t num_dirty = 0;
+    for (size_t f = 0; f < nf; ++f) {
+        if (double(hi[f] - lo[f]) <= limit)
+            continue;
+        ++num_dirty;
+        for (size_t k = f * frame_size, e = std::min(n, (f+1) * frame_size); k < e; ++k) {
+            slots.push_back(k);
+            dirty_keys.push_back(keys[k]);
+        }
+    }
+    if (num_dirty == 0)
+        return 0;
+
+    std::vector<size_t> src = slots;
+    internal::radix_sort(dirty_keys, src, pool);
+    internal::gather_selected(c, slots, src, pool);
+    return num_dirty;
+}
+
+}  // namespace aosoa
@@ -0,0 +1,134 @@
+#include "reduce.hpp"
+#include <bit>
+#include <concepts>
+#include <type_traits>
+#include <vector>
+#include <xsimd/xsimd.hpp>
+
+#pragma once
+
+namespace aosoa {
+namespace internal {
+
+// Inclusive scan of the lanes of x, in log2(S) shift-and-add steps.
+template<size_t S, typename B>
+FORCE_INLINE B scan_in_register(B x) {
+    using T = typename B::value_type;
+    tpa::constexpr_for<0, std::bit_width(S) - 1, 1>([&](auto I) {
+        constexpr size_t shift = size_t(1) << decltype(I)::value;
+        x += xsimd::slide_left<shift * sizeof(T)>(x);
+    });
+    return x;
+}
+
+// Write a batch to a field of a S-lane batch, a xsimd batch or a std::array of lanes.
+template<typename Dst, typename B>
+FORCE_INLINE void store_batch(Dst&& dst, const B& b) {
+    if constexpr (requires { dst.data(); })
+        b.store_unaligned(dst.data());
+    else
+        dst = b;
+}
+
+/**
+ * Scan [start, end) with the running sum starting at `carry`, returns the
+ * sum at the end. Each masked batch is scanned in registers, inactive lanes
+ * counting as zero.
+ */
+template<bool inclusive, size_t S, typename C, typename InFn, typename OutFn, typename T>
+T scan_range(C& c, InFn& in, OutFn& out, size_t start, size_t end, T carry) {
+    using B = xsimd::make_sized_batch_t<T, S>;
+    for (auto p : c.template mrange<S>(start, end)) {
+        static_assert(std::is_lvalue_reference_v<decltype(out(p))>,
+                "the out kernel of a scan must return a reference to the field, e.g. `[](auto p) -> auto& { return p.offset(); }`");
+        B x = components<S>(in(p))[0];
+        if (not p.full()) [[unlikely]]
+            x = xsimd::select(p.template mask<T>(), x, B(T(0)));
+        const B s = scan_in_register<S>(x);
+        if constexpr (inclusive)
+            store_batch(out(p), s + B(carry));
+        else
+            store_batch(out(p), xsimd::slide_left<sizeof(T)>(s) + B(carry));
+        carry += xsimd::reduce_add(x);
+    }
+    return carry;
+}
+
+/**
+ * Two-pass parallel scan: the sums of the per-thread chunks are computed
+ * first, their exclusive scan gives the carry each chunk is then scanned with.
+ * With a single chunk, the container is scanned in one pass.
+ */
+template<bool inclusive, size_t S, typename C, typename InFn, typename OutFn, typename T>
+void scan(C& c, InFn& in, OutFn& out, T init, ThreadPool& pool) {
+    using Scalar = typename result_components_t<S, C, InFn>::value_type::value_type;
+    static_assert(std::is_same_v<Scalar, T>, "scan requires the init value to have the type of the field");
+    constexpr size_t grain = chunk_grain<C, S>();
+    const size_t size = c.size();
+    const size_t nc = std::min(pool.size(), (size + grain - 1) / grain);
+    if (nc <= 1) {
+        scan_range<inclusive, S>(c, in, out, 0, size, init);
+        return;
+    }
+
+    std::vector<T> carry(nc);
+    pool.run(nc, [&](size_t k) {
+        using B = xsimd::make_sized_batch_t<T, S>;
+        B acc(T(0));
+        for (auto p : std::as_const(c).template mrange<S>(chunk_bound<grain>(size, k, nc), chunk_bound<grain>(size, k+1, nc))) {
+            B x = components<S>(in(p))[0];
+            acc += p.full() ? x : xsimd::select(p.template mask<T>(), x, B(T(0)));
+        }
+        carry[k] = xsimd::reduce_add(acc);
+    });
+    for (size_t k = 0; k < nc; ++k) {
+        const T sum = carry[k];
+        carry[k] = init;
+        init += sum;
+    }
+    pool.run(nc, [&](size_t k) {
+        scan_range<inclusive, S>(c, in, out, chunk_bound<grain>(size, k, nc), chunk_bound<grain>(size, k+1, nc), carry[k]);
+    });
+}
+
+}  // namespace internal
+
+/**
+ * Inclusive prefix sum of the scalar field `in`, written to the field `out`,
+ * e.g. `inclusive_scan<S>(pa, [](auto p) { return p.weight(); }, [](auto p) -> auto& { return p.cdf(); }, 0.)`.
+ * Both kernels are called on masked S-lane batches, `in` may return an
+ * expression, `out` must return a reference to the field (a plain `auto`
+ * return type would yield a copy). Element k of `out` is
+ * init + in[0] + ... + in[k].
+ */
+template<size_t S, typename C, typename InFn, typename OutFn, typename T>
+    requires( S > 1 and std::has_single_bit(S) and S <= 64 and std::is_arithmetic_v<T> )
+void inclusive_scan(C& c, InFn&& in, OutFn&& out, T init, ThreadPool& pool = default_thread_pool()) {
+    internal::scan<true, S>(c, in, out, init, pool);
+}
+
+// In-place inclusive prefix sum of the scalar field `fn`, which returns a reference to it.
+template<size_t S, typename C, typename Fn, typename T>
+    requires( S > 1 and std::has_single_bit(S) and S <= 64 and std::is_arithmetic_v<T> )
+void inclusive_scan(C& c, Fn&& fn, T init, ThreadPool& pool = default_thread_pool()) {
+    internal::scan<true, S>(c, fn, fn, init, pool);
+}
+
+/**
+ * Exclusive prefix sum of the scalar field `in`, written to the field `out`:
+ * element k of `out` is init + in[0] + ... + in[k-1]. See `inclusive_scan`.
+ */
+template<size_t S, typename C, typename InFn, typename OutFn, typename T>
+    requires( S > 1 and std::has_single_bit(S) and S <= 64 and std::is_arithmetic_v<T> )
+void exclusive_scan(C& c, InFn&& in, OutFn&& out, T init, ThreadPool& pool = default_thread_pool()) {
+    internal::scan<false, S>(c, in, out, init, pool);
+}
+
+// In-place exclusive prefix sum of the scalar field `fn`, which returns a reference to it.
+template<size_t S, typename C, typename Fn, typename T>
+    requires( S > 1 and std::has_single_bit(S) and S <= 64 and std::is_arithmetic_v<T> )
+void exclusive_scan(C& c, Fn&& fn, T init, ThreadPool& pool = default_thread_pool()) {
+    internal::scan<false, S>(c, fn, fn, init, pool);
+}
+
+}  // namespace aosoa
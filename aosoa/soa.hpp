@@ -131,6 +131,21 @@ struct StorageType<std::tuple<Ts...>, N, Frame> {
         std::tuple<typename ElemStorageType<Ts, N, Frame>::type ...> >::type;
 };
 
+// Component array padded to a multiple of `align` bytes, so that in a padded
+// frame every component starts on an alignment boundary.
+template<size_t align> struct PaddedArray {
+    template<typename T, size_t N>
+    struct alignas(align) type : public std::array<T, N> {};
+};
+
+// Storage type of a SoaArray frame, packed or padded.
+template<typename Types, size_t N, size_t align, bool padded> struct FrameStorageType {
+    using type = typename StorageType<Types, N, std::array>::type;
+};
+template<typename Types, size_t N, size_t align> struct FrameStorageType<Types, N, align, true> {
+    using type = typename StorageType<Types, N, PaddedArray<align>::template type>::type;
+};
+
 template<typename Types, size_t N> struct MinAlign : std::alignment_of<typename StorageType<Types, N, std::array>::type> {};
 
 namespace detail{
@@ -151,8 +166,8 @@ namespace detail{
     template<size_t align, typename ST>
     inline static constexpr auto storage_offset = storage_offset_impl<align, ST>();
 }
-template<typename Types, size_t N, size_t align>
-static constexpr auto storage_offset = detail::storage_offset<align, typename StorageType<Types, N, std::array>::type>;
+template<typename Types, size_t N, size_t align, bool padded = false>
+static constexpr auto storage_offset = detail::storage_offset<align, typename FrameStorageType<Types, N, align, padded>::type>;
 
 
 template<typename Types> struct const_types {};
@@ -174,6 +189,10 @@ template<typename T, size_t N> using ElemRefN = std::array<T, N>&;
 template<typename T, size_t> using ElemElem = T;
 template<typename T, size_t> using ElemVec = std::vector<T>;
 
+// Number of scalar columns of an element list.
+template<typename Types>
+inline static constexpr size_t num_columns = std::tuple_size_v<typename StorageType<Types, 0, ElemElem>::type>;
+
 
 // Container type and reference type
 template<typename Types, tpa::tuple_like Data, size_t N> class SoaRefNAny;
@@ -23,38 +23,59 @@ FORCE_INLINE auto foreach_i(T&& tp, Fn&& fn) {
             std::make_index_sequence<std::tuple_size_v<std::remove_cvref_t<T>>>{});
 }
 
-template<typename Types, size_t N, size_t align>
-class alignas(align) SoaArray : public soa::Inherited<soa::access_t<Types, SoaArray<Types, N, align>>>, public Container<SoaArray<Types, N, align>> {
+template<typename Types, size_t N, size_t align, bool padded>
+class alignas(align) SoaArray : public soa::Inherited<soa::access_t<Types, SoaArray<Types, N, align, padded>>>, public Container<SoaArray<Types, N, align, padded>> {
     public:
-        using Data = typename soa::StorageType<Types, N, std::array>::type;
-        using Self = SoaArray<Types, N, align>;
-        static constexpr auto storage_offsets = soa::storage_offset<Types, N, align>;
+        using Data = typename soa::FrameStorageType<Types, N, align, padded>::type;
+        using Self = SoaArray<Types, N, align, padded>;
+        static constexpr auto storage_offsets = soa::storage_offset<Types, N, align, padded>;
+
+        // Whether `get<S>` of component `i` yields a simd batch. In padded
+        // layout every component starts at `align`, so this only depends on S.
+        template<size_t i, size_t S>
+        static constexpr bool is_simd_component() {
+            using elem_t = typename std::tuple_element_t<i, Data>::value_type;
+            using simd_t = xsimd::make_sized_batch_t<elem_t, S>;
+            constexpr size_t offset = storage_offsets[i];
+            if constexpr (std::is_void_v<simd_t>)
+                return false;
+            else
+                return offset/sizeof(elem_t) % S == 0 and align/sizeof(elem_t) % S == 0;
+        }
+
+        // Whether `get_wide<S>` of component `i` yields register-width batches.
+        template<size_t i, size_t S>
+        static constexpr bool is_wide_component() {
+            using elem_t = typename std::tuple_element_t<i, Data>::value_type;
+            constexpr size_t lanes = native_lanes<elem_t>;
+            constexpr size_t offset = storage_offsets[i];
+            return lanes > 1 and S % lanes == 0 and offset/sizeof(elem_t) % lanes == 0 and align/sizeof(elem_t) % lanes == 0;
+        }
 
         static constexpr size_t size() { return N; }
 
         SoaArray() = default;
 
-        FORCE_INLINE auto& data() { return m_data; }
-        FORCE_INLINE const auto& data() const { return m_data; }
+        FORCE_INLINE auto& data() { return m_storage.data; }
+        FORCE_INLINE const auto& data() const { return m_storage.data; }
 
         FORCE_INLINE auto operator[](size_t idx) {
-            auto ref = tpa::foreach(m_data, [idx](auto& arr) -> auto& { return arr[idx]; });
+            auto ref = tpa::foreach(m_storage.data, [idx](auto& arr) -> auto& { return arr[idx]; });
             return soa::SoaRef<Types>(ref);
         }
 
         FORCE_INLINE auto operator[](size_t idx) const {
-            auto ref = tpa::foreach(m_data, [idx](auto& arr) -> auto& { return arr[idx]; });
+            auto ref = tpa::foreach(m_storage.data, [idx](auto& arr) -> auto& { return arr[idx]; });
             return soa::SoaRef<typename soa::const_types<Types>::type>(ref);
         }
 
         template<size_t S>
         FORCE_INLINE auto get(size_t idx) {
-            auto ref = foreach_i(m_data, [idx](auto I, auto& arr) -> auto& {
+            auto ref = foreach_i(m_storage.data, [idx](auto I, auto& arr) -> auto& {
                 constexpr size_t i = decltype(I)::value;
-                constexpr size_t offset = storage_offsets[i];
                 using elem_t = std::remove_cvref_t<decltype(arr[idx])>;
                 using simd_t = xsimd::make_sized_batch_t<elem_t, S>;
-                if constexpr (not std::is_void_v<simd_t> and offset/sizeof(elem_t) % S == 0 and align/sizeof(elem_t) % S == 0) {
+                if constexpr (is_simd_component<i, S>()) {
                     return *reinterpret_cast<simd_t*>(&arr[idx]);
                 }
                 else {
@@ -67,18 +88,17 @@ class alignas(align) SoaArray : public soa::Inherited<soa::access_t<Types, SoaAr
         template<size_t S>
         FORCE_INLINE auto get(size_t idx) const {
             /*
-            auto ref = tpa::foreach(m_data, [idx](auto& arr) -> auto& {
+            auto ref = tpa::foreach(m_storage.data, [idx](auto& arr) -> auto& {
                 using elem_t = std::remove_cvref_t<decltype(arr[idx])>;
                 return *reinterpret_cast<std::array<const elem_t, S>*>(&arr[idx]);
             });
             return soa::SoaRefN<typename soa::const_types<Types>::type, S>(ref);
             */
-            auto ref = foreach_i(m_data, [idx](auto I, auto& arr) -> auto& {
+            auto ref = foreach_i(m_storage.data, [idx](auto I, auto& arr) -> auto& {
                 constexpr size_t i = decltype(I)::value;
-                constexpr size_t offset = storage_offsets[i];
                 using elem_t = std::remove_cvref_t<decltype(arr[idx])>;
                 using simd_t = xsimd::make_sized_batch_t<elem_t, S>;
-                if constexpr (not std::is_void_v<simd_t> and offset % S == 0 and align % S == 0) {
+                if constexpr (is_simd_component<i, S>()) {
                     return *reinterpret_cast<const simd_t*>(&arr[idx]);
                 }
                 else {
@@ -88,12 +108,46 @@ class alignas(align) SoaArray : public soa::Inherited<soa::access_t<Types, SoaAr
             return soa::make_soa_refn<typename soa::const_types<Types>::type, S>(ref);
         }
 
+        // Batch of S elements where each field is made of the register-width
+        // batches of its own scalar type, see `wide_t`.
+        template<size_t S>
+        FORCE_INLINE auto get_wide(size_t idx) {
+            auto ref = foreach_i(m_storage.data, [idx](auto I, auto& arr) -> auto& {
+                constexpr size_t i = decltype(I)::value;
+                using elem_t = std::remove_cvref_t<decltype(arr[idx])>;
+                if constexpr (is_wide_component<i, S>())
+                    return *reinterpret_cast<wide_t<elem_t, S>*>(&arr[idx]);
+                else
+                    return *reinterpret_cast<std::array<elem_t, S>*>(&arr[idx]);
+            });
+            return soa::SoaRefNAny<Types, std::remove_cvref_t<decltype(ref)>, S>(ref);
+        }
+
+        template<size_t S>
+        FORCE_INLINE auto get_wide(size_t idx) const {
+            auto ref = foreach_i(m_storage.data, [idx](auto I, auto& arr) -> auto& {
+                constexpr size_t i = decltype(I)::value;
+                using elem_t = std::remove_cvref_t<decltype(arr[idx])>;
+                if constexpr (is_wide_component<i, S>())
+                    return *reinterpret_cast<const wide_t<elem_t, S>*>(&arr[idx]);
+                else
+                    return *reinterpret_cast<const std::array<elem_t, S>*>(&arr[idx]);
+            });
+            return soa::SoaRefNAny<typename soa::const_types<Types>::type, std::remove_cvref_t<decltype(ref)>, S>(ref);
+        }
+
+        // Pointer to the I-th scalar column. The argument is the frame index in Aosoa containers.
+        template<size_t I>
+        FORCE_INLINE auto* column_data(size_t = 0) { return std::get<I>(m_storage.data).data(); }
+        template<size_t I>
+        FORCE_INLINE const auto* column_data(size_t = 0) const { return std::get<I>(m_storage.data).data(); }
+
         void* write(size_t start, size_t end, void* buf) const {
             tpa::constexpr_for<0, std::tuple_size_v<Data>, 1>([&, this](auto I) {
                  constexpr size_t i = decltype(I)::value;
                  using elem_t = typename std::tuple_element_t<i, Data>::value_type;
                  const size_t n = (end-start)*sizeof(elem_t);
-                 std::memcpy(buf, std::get<i>(m_data).data()+start, n);
+                 std::memcpy(buf, std::get<i>(m_storage.data).data()+start, n);
                  buf = (char*)buf + n;
             });
             return buf;
@@ -104,7 +158,7 @@ class alignas(align) SoaArray : public soa::Inherited<soa::access_t<Types, SoaAr
                  constexpr size_t i = decltype(I)::value;
                  using elem_t = typename std::tuple_element_t<i, Data>::value_type;
                  const size_t n = count * sizeof(elem_t);
-                 std::memcpy(std::get<i>(m_data).data()+start, (elem_t*)buf + buf_start, n);
+                 std::memcpy(std::get<i>(m_storage.data).data()+start, (elem_t*)buf + buf_start, n);
                  buf = (elem_t*)buf + buf_width;
             });
         }
@@ -114,24 +168,34 @@ class alignas(align) SoaArray : public soa::Inherited<soa::access_t<Types, SoaAr
                  constexpr size_t i = decltype(I)::value;
                  using elem_t = typename std::tuple_element_t<i, Data>::value_type;
                  const size_t n = N * sizeof(elem_t);
-                 std::memcpy(std::get<i>(m_data).data(), (elem_t*)buf, n);
+                 std::memcpy(std::get<i>(m_storage.data).data(), (elem_t*)buf, n);
                  buf = (elem_t*)buf + N;
              });
         }
 
-        void merge(size_t start, size_t other_start, size_t count, const SoaArray<Types, N, align>& other) {
+        void merge(size_t start, size_t other_start, size_t count, const Self& other) {
             tpa::constexpr_for<0, std::tuple_size_v<Data>, 1>([&,  this](auto I) {
                  constexpr size_t i = decltype(I)::value;
                  using elem_t = typename std::tuple_element_t<i, Data>::value_type;
                  std::memcpy(
-                         std::get<i>(m_data).data()+start,
+                         std::get<i>(m_storage.data).data()+start,
                          std::get<i>(other.data()).data()+other_start,
                          sizeof(elem_t) * count);
             });
         }
 
     private:
-        alignas(align) Data m_data;  // an std::tuple
+        // A std::tuple is value-initialized by its default constructor, the
+        // union's leaves it uninitialized. Since that of SoaArray is not
+        // user-provided, `Frame()` (as in `resize`) still zeroes the data,
+        // while `new Frame` (as in `resize_for_overwrite`) does not.
+        union Storage {
+            Data data;
+            FORCE_INLINE Storage() {}
+            FORCE_INLINE Storage(const Storage& other) : data(other.data) {}
+            FORCE_INLINE Storage& operator=(const Storage& other) { data = other.data; return *this; }
+        };
+        alignas(align) Storage m_storage;
 };
 
 }  // namespace aosoa
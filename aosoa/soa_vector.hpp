@@ -1,5 +1,11 @@
 #include "container.hpp"
+#include "column.hpp"
 #include "soa.hpp"
+#include "aosoa_utils.hpp"
+#include <algorithm>
+#include <cstring>
+#include <span>
+#include <utility>
 #include <vector>
 #include <xsimd/xsimd.hpp>
 
@@ -7,15 +13,41 @@
 
 namespace aosoa {
 
-template<typename Types, size_t align>
+/**
+ * Container of one array per scalar column. By default each column is a
+ * std::vector. With `block`, all columns share a single aligned allocation,
+ * each starting at a multiple of `align`, so growing reallocates once and
+ * moves the columns one by one, and the columns stay close in memory.
+ */
+template<typename Types, size_t align, bool block>
     requires( internal::is_pow_2<align> )
-class SoaVector : public soa::Inherited<soa::access_t<Types, SoaVector<Types, align>>>, public Container<SoaVector<Types, align>> {
+class SoaVector : public soa::Inherited<soa::access_t<Types, SoaVector<Types, align, block>>>, public Container<SoaVector<Types, align, block>> {
     
     public:
         template<typename T, size_t>
-        using stor_vec = std::vector<T, xsimd::aligned_allocator<T, align>>;
-        using Data = typename soa::StorageType<Types, 0, stor_vec >::type;
-        using Self = SoaVector<Types, align>;
+        using stor_vec = std::vector<T, internal::default_init_allocator<T, xsimd::aligned_allocator<T, align>>>;
+        template<typename T, size_t>
+        using stor_span = std::span<T>;
+        using Data = std::conditional_t<block,
+              typename soa::StorageType<Types, 0, stor_span>::type,
+              typename soa::StorageType<Types, 0, stor_vec>::type>;
+        using Self = SoaVector<Types, align, block>;
+
+        SoaVector() = default;
+        SoaVector(const SoaVector& other) : m_data(other.m_data), m_block(other.m_block), m_capacity(other.m_capacity) {
+            if constexpr (block)
+                link(other.size());
+        }
+        SoaVector(SoaVector&& other) noexcept :
+            m_data(std::exchange(other.m_data, Data())),
+            m_block(std::move(other.m_block)),
+            m_capacity(std::exchange(other.m_capacity, 0)) {}
+        SoaVector& operator=(SoaVector other) noexcept {
+            std::swap(m_data, other.m_data);
+            std::swap(m_block, other.m_block);
+            std::swap(m_capacity, other.m_capacity);
+            return *this;
+        }
 
         FORCE_INLINE auto& data() { return m_data; }
         FORCE_INLINE const auto& data() const { return m_data; }
@@ -59,19 +91,131 @@ class SoaVector : public soa::Inherited<soa::access_t<Types, SoaVector<Types, al
             return soa::make_soa_refn<typename soa::const_types<Types>::type, S>(ref);
         }
 
+        // Batch of S elements where each field is made of the register-width
+        // batches of its own scalar type, see `wide_t`.
+        template<size_t S>
+        FORCE_INLINE auto get_wide(size_t idx) {
+            auto ref = tpa::foreach(m_data, [idx](auto& arr) -> auto& {
+                using elem_t = std::remove_cvref_t<decltype(arr[idx])>;
+                if constexpr (native_lanes<elem_t> > 1 and align/sizeof(elem_t) % native_lanes<elem_t> == 0)
+                    return *reinterpret_cast<wide_t<elem_t, S>*>(&arr[idx]);
+                else
+                    return *reinterpret_cast<std::array<elem_t, S>*>(&arr[idx]);
+            });
+            return soa::SoaRefNAny<Types, std::remove_cvref_t<decltype(ref)>, S>(ref);
+        }
+
+        template<size_t S>
+        FORCE_INLINE auto get_wide(size_t idx) const {
+            auto ref = tpa::foreach(m_data, [idx](auto& arr) -> auto& {
+                using elem_t = std::remove_cvref_t<decltype(arr[idx])>;
+                if constexpr (native_lanes<elem_t> > 1 and align/sizeof(elem_t) % native_lanes<elem_t> == 0)
+                    return *reinterpret_cast<const wide_t<elem_t, S>*>(&arr[idx]);
+                else
+                    return *reinterpret_cast<const std::array<elem_t, S>*>(&arr[idx]);
+            });
+            return soa::SoaRefNAny<typename soa::const_types<Types>::type, std::remove_cvref_t<decltype(ref)>, S>(ref);
+        }
+
+        // Pointer to the I-th scalar column. The argument is the frame index in Aosoa containers.
+        template<size_t I>
+        FORCE_INLINE auto* column_data(size_t = 0) { return std::get<I>(m_data).data(); }
+        template<size_t I>
+        FORCE_INLINE const auto* column_data(size_t = 0) const { return std::get<I>(m_data).data(); }
+
+        // Component K of the field F as a std::span over the column, e.g.
+        // `pa.column<pos, 1>()`. See column.hpp.
+        template<template<typename, size_t> typename F, size_t K = 0> auto column() { return make_column<F, K>(this); }
+        template<template<typename, size_t> typename F, size_t K = 0> auto column() const { return make_column<F, K>(this); }
+
         // Container methods
         void resize(size_t new_size) {
-            tpa::apply_unary_op([new_size](auto& row) {
-                row.resize(new_size);
-                return 0;
-            }, m_data);
+            const size_t old_size = size();
+            resize_for_overwrite(new_size);
+            if (new_size > old_size) {
+                tpa::apply_unary_op([old_size](auto& row) {
+                    std::fill(row.begin() + old_size, row.end(), typename std::remove_cvref_t<decltype(row)>::value_type());
+                    return 0;
+                }, m_data);
+            }
+        }
+
+        // Resize leaving new elements uninitialized, for elements about to be overwritten.
+        void resize_for_overwrite(size_t new_size) {
+            if constexpr (block) {
+                if (new_size > m_capacity)
+                    reallocate(std::max(new_size, 2 * m_capacity));
+                link(new_size);
+            }
+            else {
+                tpa::apply_unary_op([new_size](auto& row) {
+                    row.resize(new_size);
+                    return 0;
+                }, m_data);
+            }
+        }
+
+        void reserve(size_t capacity) {
+            if constexpr (block) {
+                if (capacity > m_capacity)
+                    reallocate(capacity);
+            }
+            else {
+                tpa::apply_unary_op([capacity](auto& row) {
+                    row.reserve(capacity);
+                    return 0;
+                }, m_data);
+            }
         }
 
         size_t size() const { return std::get<0>(m_data).size(); };
 
     private:
+        static constexpr size_t num_columns = std::tuple_size_v<Data>;
+        using Block = std::vector<char, internal::default_init_allocator<char, xsimd::aligned_allocator<char, align>>>;
+
         Data m_data;
+        // Block mode: the columns of m_capacity elements each
+        Block m_block;
+        size_t m_capacity = 0;
 
+        // Bytes of the I-th column of `capacity` elements in the block
+        template<size_t I>
+        static constexpr size_t column_bytes(size_t capacity) {
+            using elem_t = typename std::tuple_element_t<I, Data>::value_type;
+            return (capacity * sizeof(elem_t) + align - 1) / align * align;
+        }
+
+        // Point the columns to the block, with `num` elements.
+        void link(size_t num) {
+            char* p = m_block.data();
+            tpa::constexpr_for<0, num_columns, 1>([&, this](auto I) {
+                constexpr size_t i = decltype(I)::value;
+                using elem_t = typename std::tuple_element_t<i, Data>::value_type;
+                std::get<i>(m_data) = std::span<elem_t>(reinterpret_cast<elem_t*>(p), num);
+                p += column_bytes<i>(m_capacity);
+            });
+        }
+
+        // Move the columns to a new block of `capacity` elements each.
+        void reallocate(size_t capacity) {
+            size_t bytes = 0;
+            tpa::constexpr_for<0, num_columns, 1>([&](auto I) {
+                bytes += column_bytes<decltype(I)::value>(capacity);
+            });
+            const size_t num = size();
+            const Data old = m_data;
+            Block previous(bytes);
+            std::swap(m_block, previous);  // previous keeps the old columns alive until copied
+            m_capacity = capacity;
+            link(num);
+            if (num > 0) {
+                tpa::constexpr_for<0, num_columns, 1>([&, this](auto I) {
+                    constexpr size_t i = decltype(I)::value;
+                    std::memcpy(std::get<i>(m_data).data(), std::get<i>(old).data(), std::get<i>(old).size_bytes());
+                });
+            }
+        }
 };
 
 } // namespace aosoa
@@ -0,0 +1,256 @@
+#include "algorithm.hpp"
+#include "parallel.hpp"
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#pragma once
+
+namespace aosoa {
+namespace internal {
+
+inline static constexpr size_t min_chunk_elems = 4096;
+
+FORCE_INLINE size_t num_chunks(size_t n, const ThreadPool& pool) {
+    return std::max<size_t>(1, std::min(pool.size(), n / min_chunk_elems));
+}
+
+FORCE_INLINE size_t chunk_begin(size_t n, size_t k, size_t num_chunks) { return n * k / num_chunks; }
+
+// Frame and offset of every source index of Aosoa containers, computed once
+// for all columns. Empty for contiguous containers.
+template<typename C>
+std::vector<std::pair<uint32_t, uint32_t>> source_locations(const std::vector<size_t>& perm, ThreadPool& pool) {
+    constexpr size_t capacity = segment_capacity<C>;
+    std::vector<std::pair<uint32_t, uint32_t>> loc;
+    if constexpr (is_aosoa<C>) {
+        const size_t n = perm.size(), nc = num_chunks(n, pool);
+        loc.resize(n);
+        pool.run(nc, [&](size_t t) {
+            for (size_t k = chunk_begin(n, t, nc), e = chunk_begin(n, t+1, nc); k < e; ++k)
+                loc[k] = {uint32_t(perm[k] / capacity), uint32_t(perm[k] % capacity)};
+        });
+    }
+    return loc;
+}
+
+template<size_t I, typename C>
+std::vector<column_t<C, I>*> column_segments(C& c) {
+    std::vector<column_t<C, I>*> segs(num_segments(c));
+    for (size_t s = 0; s < segs.size(); ++s)
+        segs[s] = c.template column_data<I>(s);
+    return segs;
+}
+
+/**
+ * Reorder the elements so that element k is the former element perm[k],
+ * one column at a time: the column is gathered into a buffer, then copied
+ * back segment by segment.
+ */
+template<typename C>
+void gather_columns(C& c, const std::vector<size_t>& perm, ThreadPool& pool) {
+    constexpr size_t capacity = segment_capacity<C>;
+    const size_t n = c.size(), nc = num_chunks(n, pool);
+    const auto loc = source_locations<C>(perm, pool);
+
+    for_each_column<C>([&](auto I) {
+        constexpr size_t i = decltype(I)::value;
+        using T = column_t<C, i>;
+        const auto segs = column_segments<i>(c);
+        std::unique_ptr<T[]> tmp(new T[n]);
+
+        pool.run(nc, [&](size_t t) {
+            const size_t e = chunk_begin(n, t+1, nc);
+            for (size_t k = chunk_begin(n, t, nc); k < e; ++k) {
+                if constexpr (is_aosoa<C>)
+                    tmp[k] = segs[loc[k].first][loc[k].second];
+                else
+                    tmp[k] = segs[0][perm[k]];
+            }
+        });
+        pool.run(nc, [&](size_t t) {
+            const size_t e = chunk_begin(n, t+1, nc);
+            for (size_t k = chunk_begin(n, t, nc); k < e;) {
+                const size_t offset = k % capacity, len = std::min(e - k, capacity - offset);
+                std::copy_n(&tmp[k], len, segs[k / capacity] + offset);
+                k += len;
+            }
+        });
+    });
+}
+
+/**
+ * Same as gather_columns, following the cycles of the permutation within
+ * each column instead of using a buffer. Only a bitmask of visited elements
+ * is allocated per column. The columns are permuted in parallel.
+ */
+template<typename C>
+void permute_columns_in_place(C& c, const std::vector<size_t>& perm, ThreadPool& pool) {
+    constexpr size_t capacity = segment_capacity<C>;
+    const size_t n = c.size();
+
+    pool.run(num_columns<C>, [&](size_t col) {
+        for_each_column<C>([&](auto I) {
+            constexpr size_t i = decltype(I)::value;
+            if (i != col) return;
+            const auto segs = column_segments<i>(c);
+            // Element perm[k], i.e. the one moving to k. Located from its
+            // index, so that no memory beyond the bitmask is needed.
+            auto source = [&](size_t k) -> auto& {
+                if constexpr (is_aosoa<C>)
+                    return segs[perm[k] / capacity][perm[k] % capacity];
+                else
+                    return segs[0][perm[k]];
+            };
+
+            std::vector<uint64_t> visited((n + 63) / 64, 0);
+            for (size_t start = 0; start < n; ++start) {
+                if (test_bit(visited, start) or perm[start] == start)
+                    continue;
+                // The element written at each step is read at the next, so
+                // only the start of the cycle is located from its index.
+                auto* dst = is_aosoa<C> ? &segs[start / capacity][start % capacity] : &segs[0][start];
+                const auto tmp = *dst;
+                size_t k = start;
+                while (true) {
+                    visited[k/64] |= uint64_t(1) << (k%64);
+                    if (perm[k] == start) {
+                        *dst = tmp;
+                        break;
+                    }
+                    auto* src = &source(k);
+                    *dst = *src;
+                    dst = src;
+                    k = perm[k];
+                }
+            }
+        });
+    });
+}
+
+/**
+ * Stable LSD radix sort of `keys`, 8 bits per pass, carrying `perm` along.
+ * Only the passes over bytes that differ between keys are run. Every chunk of
+ * the input has its own histogram, so the passes are parallel.
+ */
+template<std::unsigned_integral K>
+void radix_sort(std::vector<K>& keys, std::vector<size_t>& perm, ThreadPool& pool) {
+    constexpr size_t radix_bits = 8, num_buckets = size_t(1) << radix_bits;
+    const size_t n = keys.size(), nc = num_chunks(n, pool);
+    if (n < 2) return;
+
+    // bits that differ between some keys
+    std::vector<K> ors(nc, 0), ands(nc, std::numeric_limits<K>::max());
+    pool.run(nc, [&](size_t t) {
+        for (size_t k = chunk_begin(n, t, nc), e = chunk_begin(n, t+1, nc); k < e; ++k) {
+            ors[t] |= keys[k];
+            ands[t] &= keys[k];
+        }
+    });
+    K all_or = 0, all_and = std::numeric_limits<K>::max();
+    for (size_t t = 0; t < nc; ++t) {
+        all_or |= ors[t];
+        all_and &= ands[t];
+    }
+    const K varying = all_or & ~all_and;
+
+    std::vector<K> keys_tmp(n);
+    std::vector<size_t> perm_tmp(n);
+    std::vector<std::array<size_t, num_buckets>> offsets(nc);
+
+    for (size_t shift = 0; shift < sizeof(K) * 8; shift += radix_bits) {
+        if (((varying >> shift) & (num_buckets - 1)) == 0)
+            continue;
+
+        pool.run(nc, [&](size_t t) {
+            auto& hist = offsets[t];
+            hist.fill(0);
+            for (size_t k = chunk_begin(n, t, nc), e = chunk_begin(n, t+1, nc); k < e; ++k)
+                ++hist[(keys[k] >> shift) & (num_buckets - 1)];
+        });
+        size_t sum = 0;
+        for (size_t d = 0; d < num_buckets; ++d) {
+            for (size_t t = 0; t < nc; ++t) {
+                size_t count = offsets[t][d];
+                offsets[t][d] = sum;
+                sum += count;
+            }
+        }
+        pool.run(nc, [&](size_t t) {
+            auto& offset = offsets[t];
+            for (size_t k = chunk_begin(n, t, nc), e = chunk_begin(n, t+1, nc); k < e; ++k) {
+                size_t pos = offset[(keys[k] >> shift) & (num_buckets - 1)]++;
+                keys_tmp[pos] = keys[k];
+                perm_tmp[pos] = perm[k];
+            }
+        });
+        keys.swap(keys_tmp);
+        perm.swap(perm_tmp);
+    }
+}
+
+// Map integer keys to unsigned ones with the same order.
+template<std::integral R>
+FORCE_INLINE auto radix_key(R key) {
+    using K = std::make_unsigned_t<R>;
+    if constexpr (std::is_signed_v<R>)
+        return K(key) ^ (K(1) << (sizeof(K) * 8 - 1));
+    else
+        return K(key);
+}
+
+}  // namespace internal
+
+enum class PermuteMode {
+    gather,     // column-sized buffer, streaming writes
+    in_place    // cycle following, one bit per element of extra memory
+};
+
+/**
+ * Reorder the elements so that element k is the former element perm[k].
+ * `perm` must be a permutation of [0, size()).
+ */
+template<typename C>
+void apply_permutation(C& c, const std::vector<size_t>& perm, PermuteMode mode = PermuteMode::gather,
+        ThreadPool& pool = default_thread_pool()) {
+    if (mode == PermuteMode::gather)
+        internal::gather_columns(c, perm, pool);
+    else
+        internal::permute_columns_in_place(c, perm, pool);
+}
+
+/**
+ * Stable sort of the container by an integer key, e.g.
+ * `sort_by_key(pa, [](auto p) { return p.cell(); })`. The keys are sorted by
+ * a parallel radix sort together with the element indices, then the columns
+ * are reordered one at a time.
+ */
+template<typename C, typename KeyFn>
+void sort_by_key(C& c, KeyFn&& key_fn, ThreadPool& pool = default_thread_pool()) {
+    using R = std::remove_cvref_t<decltype(key_fn(std::as_const(c)[0]))>;
+    static_assert(std::is_integral_v<R>, "sort_by_key requires integer keys");
+    using K = std::make_unsigned_t<R>;
+
+    const size_t n = c.size(), nc = internal::num_chunks(n, pool);
+    std::vector<K> keys(n);
+    std::vector<size_t> perm(n);
+    pool.run(nc, [&](size_t t) {
+        size_t k = internal::chunk_begin(n, t, nc);
+        const size_t e = internal::chunk_begin(n, t+1, nc);
+        for (auto it = std::as_const(c).begin() + k; k < e; ++it, ++k) {
+            keys[k] = internal::radix_key(key_fn(*it));
+            perm[k] = k;
+        }
+    });
+
+    internal::radix_sort(keys, perm, pool);
+    internal::gather_columns(c, perm, pool);
+}
+
+}  // namespace aosoa
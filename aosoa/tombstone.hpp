@@ -0,0 +1,203 @@
+#include "algorithm.hpp"
+#include "masked.hpp"
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+#pragma once
+
+namespace aosoa {
+
+template<typename C>
+class Tombstoned;
+
+/**
+ * Iterate over the S-lane batches of a Tombstoned container holding at least
+ * one live element. The active lanes of each batch are its live elements.
+ */
+template<typename C, size_t S, bool const_iter>
+class TombstoneIter {
+    public:
+        using Owner = std::conditional_t<const_iter, const Tombstoned<C>, Tombstoned<C>>;
+        using difference_type = std::ptrdiff_t;
+        using value_type = void;
+        using iterator_category = std::forward_iterator_tag;
+        using Self = TombstoneIter<C, S, const_iter>;
+
+        FORCE_INLINE TombstoneIter() : m_owner(nullptr), m_index(0) {}
+        FORCE_INLINE TombstoneIter(Owner* owner, size_t index) : m_owner(owner), m_index(index) { skip(); }
+
+        FORCE_INLINE MaskedRefN<C, S, const_iter> operator*() const {
+            const size_t size = m_owner->size();
+            return MaskedRefN<C, S, const_iter>(&m_owner->container(), m_index,
+                    std::min(S, size - m_index), m_owner->template batch_bits<S>(m_index));
+        }
+
+        FORCE_INLINE size_t index() const { return m_index; }
+
+        FORCE_INLINE auto& operator++() { m_index += S; skip(); return *this; }
+        FORCE_INLINE auto operator++(int) { auto ret = *this; ++(*this); return ret; }
+
+        FORCE_INLINE bool operator==(const Self& other) const { return m_index == other.index(); }
+
+    private:
+        Owner *m_owner;
+        size_t m_index;
+
+        FORCE_INLINE void skip() {
+            const size_t size = m_owner->size();
+            while (m_index < size and m_owner->template batch_bits<S>(m_index) == 0)
+                m_index += S;
+            m_index = std::min(m_index, size);
+        }
+};
+
+template<typename C, size_t S, bool const_iter>
+class TombstoneRangeProxy {
+    public:
+        using Iter = TombstoneIter<C, S, const_iter>;
+        TombstoneRangeProxy(typename Iter::Owner* owner) : m_owner(owner) {}
+
+        auto begin() const { return Iter(m_owner, 0); }
+        auto end() const { return Iter(m_owner, m_owner->size()); }
+
+    private:
+        typename Iter::Owner *m_owner;
+};
+
+/**
+ * Aosoa container with lazy deletion. Every frame has an occupancy bitmask,
+ * erased elements are only marked dead, and `range<S>()` yields masked
+ * batches whose active lanes are the live elements. The holes are removed by
+ * `compact()`, which `maybe_compact()` runs once they exceed a fraction of
+ * the size. Indices of live elements are stable until compaction.
+ */
+template<typename C>
+class Tombstoned {
+    public:
+        using Container = C;
+        static constexpr size_t frame_size = aosoa_traits<C>::frame_size;
+        static constexpr size_t words_per_frame = (frame_size + 63) / 64;
+
+        static_assert(internal::is_aosoa<C>, "Tombstoned requires an AosoaVector or AosoaList");
+
+        explicit Tombstoned(double max_hole_fraction = 0.25) :
+            m_max_hole_fraction(max_hole_fraction), m_holes(0) {}
+
+        C& container() { return m_data; }
+        const C& container() const { return m_data; }
+
+        // Number of slots, live or dead.
+        size_t size() const { return m_data.size(); }
+        size_t num_holes() const { return m_holes; }
+        size_t num_alive() const { return size() - m_holes; }
+        double hole_fraction() const { return size() > 0 ? double(m_holes) / size() : 0.; }
+
+        double max_hole_fraction() const { return m_max_hole_fraction; }
+        void set_max_hole_fraction(double fraction) { m_max_hole_fraction = fraction; }
+
+        FORCE_INLINE auto operator[](size_t i) { return m_data[i]; }
+        FORCE_INLINE auto operator[](size_t i) const { return m_data[i]; }
+
+        // New slots are live.
+        void resize(size_t new_size) {
+            const size_t old_size = size();
+            for (size_t i = new_size; i < old_size; ++i)
+                if (not alive(i)) --m_holes;
+            m_data.resize(new_size);
+            m_occupancy.resize(m_data.num_frames() * words_per_frame, 0);
+            for (size_t i = old_size; i < new_size; ++i)
+                word(i) |= bit(i);
+            for (size_t i = new_size; i < old_size and i < m_data.num_frames() * frame_size; ++i)
+                word(i) &= ~bit(i);
+        }
+
+        void clear() { m_data.clear(); m_occupancy.clear(); m_holes = 0; }
+
+        FORCE_INLINE bool alive(size_t i) const { return word(i) & bit(i); }
+
+        FORCE_INLINE void erase(size_t i) {
+            if (alive(i)) {
+                word(i) &= ~bit(i);
+                ++m_holes;
+            }
+        }
+
+        // Occupancy bits of the S elements starting at `idx`, a multiple of S.
+        template<size_t S>
+        FORCE_INLINE uint64_t batch_bits(size_t idx) const {
+            static_assert(64 % S == 0 and frame_size % S == 0, "batches must not straddle occupancy words");
+            if constexpr (S == 64)
+                return word(idx);
+            else
+                return (word(idx) >> ((idx % frame_size) % 64)) & ((uint64_t(1) << S) - 1);
+        }
+
+        /**
+         * Mark dead the live elements for which `pred`, called on the masked
+         * batches of `range<S>()`, is true. Returns the number of erased
+         * elements.
+         */
+        template<size_t S, typename Pred>
+        size_t erase_if(Pred&& pred) {
+            size_t erased = 0;
+            for (auto p : std::as_const(*this).template range<S>()) {
+                const uint64_t dead = internal::mask_bits(pred(p)) & p.bits();
+                if (dead == 0) continue;
+                const size_t shift = (p.index() % frame_size) % 64;
+                word(p.index()) &= ~(dead << shift);
+                erased += std::popcount(dead);
+            }
+            m_holes += erased;
+            return erased;
+        }
+
+        // Remove the holes, keeping the order of live elements.
+        void compact() {
+            if (m_holes == 0) return;
+            std::vector<uint64_t> keep;
+            if constexpr (frame_size % 64 == 0)
+                keep = m_occupancy;
+            else {
+                keep.assign((size() + 63) / 64, 0);
+                for (size_t f = 0; f < m_data.num_frames(); ++f)
+                    for (size_t w = 0; w < words_per_frame; ++w)
+                        internal::set_bits(keep, f * frame_size + w * 64,
+                                m_occupancy[f * words_per_frame + w], std::min<size_t>(64, frame_size - w * 64));
+            }
+            const size_t alive = num_alive();
+            aosoa::compact(m_data, keep);
+            m_holes = 0;
+            m_occupancy.assign(m_data.num_frames() * words_per_frame, 0);
+            for (size_t i = 0; i < alive; ++i)
+                word(i) |= bit(i);
+        }
+
+        // Compact if the holes exceed the maximal fraction, returns whether it did.
+        bool maybe_compact() {
+            if (hole_fraction() <= m_max_hole_fraction)
+                return false;
+            compact();
+            return true;
+        }
+
+        template<size_t S> requires( S > 0 )
+        auto range() { return TombstoneRangeProxy<C, S, false>(this); }
+        template<size_t S> requires( S > 0 )
+        auto range() const { return TombstoneRangeProxy<C, S, true>(this); }
+
+    private:
+        C m_data;
+        std::vector<uint64_t> m_occupancy;
+        double m_max_hole_fraction;
+        size_t m_holes;
+
+        FORCE_INLINE static size_t word_index(size_t i) {
+            return i / frame_size * words_per_frame + (i % frame_size) / 64;
+        }
+        FORCE_INLINE static uint64_t bit(size_t i) { return uint64_t(1) << ((i % frame_size) % 64); }
+        FORCE_INLINE uint64_t& word(size_t i) { return m_occupancy[word_index(i)]; }
+        FORCE_INLINE uint64_t word(size_t i) const { return m_occupancy[word_index(i)]; }
+};
+
+}  // namespace aosoa
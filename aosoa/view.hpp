@@ -0,0 +1,269 @@
+#include "container.hpp"
+#include "algorithm.hpp"
+#include "field.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#pragma once
+
+namespace aosoa {
+
+namespace internal {
+
+// Element type of the field F in Types.
+template<template<typename, size_t> typename F, typename Types> struct field_type {};
+template<template<typename, size_t> typename F, typename T1, typename...Ts>
+struct field_type<F, std::tuple<T1, Ts...>> :
+    std::conditional_t<is_field<F, T1>::value, std::type_identity<T1>, field_type<F, std::tuple<Ts...>>> {};
+
+template<typename C, template<typename, size_t> typename...Fs>
+using view_types = std::tuple<typename field_type<Fs, typename aosoa_traits<std::remove_const_t<C>>::types>::type...>;
+
+/**
+ * Call fn(ptr, len) on the contiguous runs of the I-th column of c covering
+ * the elements [start, end).
+ */
+template<size_t I, typename C, typename Fn>
+FORCE_INLINE void for_each_run(C& c, size_t start, size_t end, Fn&& fn) {
+    constexpr size_t capacity = segment_capacity<C>;
+    while (start < end) {
+        if constexpr (is_aosoa<C>) {
+            const size_t offset = start % capacity, len = std::min(end - start, capacity - offset);
+            fn(c.template column_data<I>(start / capacity) + offset, len);
+            start += len;
+        }
+        else {
+            fn(c.template column_data<I>(0) + start, end - start);
+            start = end;
+        }
+    }
+}
+
+}  // namespace internal
+
+template<typename C, template<typename, size_t> typename...Fs>
+struct aosoa_traits<View<C, Fs...>> {
+    using base_traits = aosoa_traits<std::remove_const_t<C>>;
+    using types = std::conditional_t<std::is_const_v<C>,
+          typename soa::const_types<internal::view_types<C, Fs...>>::type,
+          internal::view_types<C, Fs...>>;
+    static constexpr size_t frame_size = base_traits::frame_size;
+    static constexpr size_t elem_size = soa::elems_size<internal::view_types<C, Fs...>>::value;
+    static constexpr size_t align_bytes = base_traits::align_bytes;
+    static constexpr bool padded = base_traits::padded;
+};
+
+// Range proxy P over its own copy of a view, see View::make_range.
+template<typename P>
+class ViewRangeProxy {
+    public:
+        using Self = std::remove_const_t<typename P::Base>;
+
+        template<typename...Args>
+        ViewRangeProxy(const Self& view, Args...args) : m_view(view), m_proxy(&m_view, args...) {}
+        ViewRangeProxy(const ViewRangeProxy&) = delete;
+        ViewRangeProxy& operator=(const ViewRangeProxy&) = delete;
+
+        auto begin() const { return m_proxy.begin(); }
+        auto end() const { return m_proxy.end(); }
+
+    private:
+        Self m_view;
+        P m_proxy;
+};
+
+/**
+ * Container view of the fields Fs of a container, e.g. `pa.view<pos, vel>()`.
+ * Iterating it with `range<S>()` / `urange<S>()` yields batches exposing
+ * only these fields, and `column_data<I>` refers to the columns of the
+ * container, so column algorithms on the view only touch those columns. The
+ * view can prefetch its columns ahead of the iteration (`with_prefetch`), and
+ * is the unit of field-selective copy (`copy_fields`) and serialization.
+ *
+ * The view does not own the elements and cannot change their number. Its
+ * ranges hold a copy of it, so a temporary view can be iterated directly,
+ * e.g. `for (auto p : pa.view<pos, vel>().range<S>())`.
+ */
+template<typename C, template<typename, size_t> typename...Fs>
+class View : public Container<View<C, Fs...>> {
+    public:
+        using Base = std::remove_const_t<C>;
+        using Types = typename aosoa_traits<View>::types;
+        using ConstTypes = typename soa::const_types<Types>::type;
+        using Self = View<C, Fs...>;
+        static constexpr size_t num_columns = soa::num_columns<Types>;
+
+        // Scalar column of the container of each column of the view.
+        static constexpr std::array<size_t, num_columns> columns = [] {
+            using base_types = typename aosoa_traits<Base>::types;
+            std::array<size_t, num_columns> result{};
+            size_t j = 0;
+            ([&] {
+                constexpr auto loc = internal::locate_field<Fs>(static_cast<base_types*>(nullptr));
+                static_assert(loc.second > 0, "no such field in the container");
+                for (size_t d = 0; d < loc.second; ++d)
+                    result[j++] = loc.first + d;
+            }(), ...);
+            return result;
+        }();
+
+        explicit View(C* c) : m_c(c) {}
+
+        FORCE_INLINE C& base() const { return *m_c; }
+
+        // Ranges over a copy of the view, see Container::make_range.
+        template<typename P, typename D, typename...Args>
+        FORCE_INLINE static auto make_range(D* d, Args...args) { return ViewRangeProxy<P>(*d, args...); }
+        FORCE_INLINE size_t size() const { return m_c->size(); }
+
+        FORCE_INLINE auto operator[](size_t i) { return soa::SoaRef<Types>(select((*m_c)[i].data())); }
+        FORCE_INLINE auto operator[](size_t i) const { return soa::SoaRef<ConstTypes>(select(std::as_const(*m_c)[i].data())); }
+
+        template<size_t S>
+        FORCE_INLINE auto get(size_t i) {
+            if (m_prefetch_distance) [[unlikely]]
+                prefetch(i + m_prefetch_distance);
+            auto ref = m_c->template get<S>(i);
+            return soa::make_soa_refn<Types, S>(select(ref.data()));
+        }
+        template<size_t S>
+        FORCE_INLINE auto get(size_t i) const {
+            if (m_prefetch_distance) [[unlikely]]
+                prefetch(i + m_prefetch_distance);
+            auto ref = std::as_const(*m_c).template get<S>(i);
+            return soa::make_soa_refn<ConstTypes, S>(select(ref.data()));
+        }
+
+        template<size_t S>
+        FORCE_INLINE auto get_wide(size_t i) {
+            auto ref = select(m_c->template get_wide<S>(i).data());
+            return soa::SoaRefNAny<Types, decltype(ref), S>(ref);
+        }
+        template<size_t S>
+        FORCE_INLINE auto get_wide(size_t i) const {
+            auto ref = select(std::as_const(*m_c).template get_wide<S>(i).data());
+            return soa::SoaRefNAny<ConstTypes, decltype(ref), S>(ref);
+        }
+
+        template<size_t J>
+        FORCE_INLINE auto* column_data(size_t seg) { return m_c->template column_data<columns[J]>(seg); }
+        template<size_t J>
+        FORCE_INLINE const auto* column_data(size_t seg) const { return std::as_const(*m_c).template column_data<columns[J]>(seg); }
+
+        // Aosoa containers: frames of the container, for column algorithms.
+        FORCE_INLINE size_t num_frames() const requires( internal::is_aosoa<Base> ) { return m_c->num_frames(); }
+
+        /**
+         * Copy of the view whose batch accesses (`get<S>`, hence `range<S>()`)
+         * prefetch the columns `distance` elements ahead. Locality 0 is a
+         * streaming (non-temporal) hint, 3 keeps the data in all cache levels.
+         */
+        template<int locality = 3>
+        Self with_prefetch(size_t distance) const {
+            Self result = *this;
+            result.m_prefetch_distance = distance;
+            result.m_locality = locality;
+            return result;
+        }
+
+        // Prefetch the columns of the view at element i, if it exists.
+        template<bool write = false, int locality = 3>
+        FORCE_INLINE void prefetch(size_t i) const {
+            if (i >= size())
+                return;
+            constexpr size_t capacity = internal::segment_capacity<Base>;
+            const size_t seg = internal::is_aosoa<Base> ? i / capacity : 0,
+                         offset = internal::is_aosoa<Base> ? i % capacity : i;
+            tpa::constexpr_for<0, num_columns, 1>([&, this](auto J) {
+                const auto* p = std::as_const(*m_c).template column_data<columns[decltype(J)::value]>(seg) + offset;
+                if constexpr (write or locality != 3)
+                    __builtin_prefetch(p, write, locality);
+                else {
+                    switch (m_locality) {
+                        case 0: __builtin_prefetch(p, 0, 0); break;
+                        case 1: __builtin_prefetch(p, 0, 1); break;
+                        case 2: __builtin_prefetch(p, 0, 2); break;
+                        default: __builtin_prefetch(p, 0, 3);
+                    }
+                }
+            });
+        }
+
+        // Serialized size of the fields of [start, end).
+        size_t serialize_size(size_t start, size_t end) const {
+            return (end - start) * aosoa_traits<View>::elem_size + sizeof(uint64_t);
+        }
+
+        // Write the fields of [start, end): their number, then column by column.
+        void* serialize(size_t start, size_t end, void* buf) const {
+            *(uint64_t*)buf = end - start;
+            buf = (char*)buf + sizeof(uint64_t);
+            tpa::constexpr_for<0, num_columns, 1>([&, this](auto J) {
+                internal::for_each_run<columns[decltype(J)::value]>(std::as_const(*m_c), start, end, [&](const auto* p, size_t len) {
+                    std::memcpy(buf, p, len * sizeof(*p));
+                    buf = (char*)buf + len * sizeof(*p);
+                });
+            });
+            return buf;
+        }
+
+        /**
+         * Overwrite the fields of the elements from `start` with serialized
+         * data. The container must already hold these elements.
+         */
+        void* deserialize(size_t start, void* buf) requires( not std::is_const_v<C> ) {
+            const size_t num = *(uint64_t*)buf;
+            buf = (char*)buf + sizeof(uint64_t);
+            tpa::constexpr_for<0, num_columns, 1>([&, this](auto J) {
+                internal::for_each_run<columns[decltype(J)::value]>(*m_c, start, start + num, [&](auto* p, size_t len) {
+                    std::memcpy(p, buf, len * sizeof(*p));
+                    buf = (char*)buf + len * sizeof(*p);
+                });
+            });
+            return buf;
+        }
+
+    private:
+        C* m_c;
+        size_t m_prefetch_distance = 0;
+        int m_locality = 3;
+
+        // Columns of the view among the references to all columns.
+        template<typename Data>
+        static FORCE_INLINE auto select(Data&& data) {
+            using D = std::remove_cvref_t<Data>;
+            return [&]<size_t...J>(std::index_sequence<J...>) {
+                return std::tuple<std::tuple_element_t<columns[J], D>...>(std::get<columns[J]>(data)...);
+            }(std::make_index_sequence<num_columns>{});
+        }
+};
+
+/**
+ * Copy the fields of the view `src` to the view `dst` of the same fields,
+ * possibly of another container type, for the first min(sizes) elements.
+ */
+template<typename D, typename Src>
+void copy_fields(D&& dst, const Src& src) {
+    using DV = std::remove_cvref_t<D>;
+    static_assert(std::is_same_v<typename soa::const_types<typename DV::Types>::type,
+                                 typename soa::const_types<typename Src::Types>::type>,
+                  "views of different fields");
+    using DB = std::remove_cvref_t<decltype(dst.base())>;
+    const size_t n = std::min(dst.size(), src.size());
+    tpa::constexpr_for<0, DV::num_columns, 1>([&](auto J) {
+        constexpr size_t j = decltype(J)::value;
+        internal::ColumnWriter<DV::columns[j], DB> out(dst.base(), 0);
+        internal::for_each_run<Src::columns[j]>(std::as_const(src.base()), 0, n, [&](const auto* p, size_t len) {
+            for (size_t k = 0; k < len; ++k)
+                out.push(p[k]);
+        });
+    });
+}
+
+}  // namespace aosoa
@@ -0,0 +1,125 @@
+#include "predeclarition.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <xsimd/xsimd.hpp>
+
+#pragma once
+
+namespace aosoa {
+
+/**
+ * Mixed-type batches. `get<S>` gives every field the same S lanes, so with
+ * S the lanes of a double batch an int32_t field only fills half a register.
+ * `get_wide<S>` instead gives each field the register-width batches of its
+ * own scalar type: with S = wide_lanes<Types> (the lanes of the narrowest
+ * type) an int32_t field is a std::array of one batch<int32_t> and a
+ * double field a std::array of two batch<double>, both supported by the
+ * tuple arithmetic operators; kernels needing the register itself write
+ * `p.id()[0]`. `convert<U>` moves values between these layouts.
+ */
+
+template<typename B, size_t S, bool const_iter>
+class WideIter {
+    public:
+        using Base = std::conditional_t<const_iter, const B, B>;
+        using difference_type = std::ptrdiff_t;
+        using value_type = void;
+        using iterator_category = std::forward_iterator_tag;
+        using Self = WideIter<B, S, const_iter>;
+
+        FORCE_INLINE WideIter() : m_data(nullptr), m_index(0) {}
+        FORCE_INLINE WideIter(Base* base, size_t index) : m_data(base), m_index(index) {}
+
+        FORCE_INLINE auto operator*() const { return m_data->template get_wide<S>(m_index); }
+
+        FORCE_INLINE size_t index() const { return m_index; }
+
+        FORCE_INLINE auto& operator++() { m_index += S; return *this; }
+        FORCE_INLINE auto operator++(int) { auto ret = *this; m_index += S; return ret; }
+
+        FORCE_INLINE bool operator==(const Self& other) const { return m_index == other.index(); }
+
+    private:
+        Base *m_data;
+        size_t m_index;
+};
+
+template<typename B, size_t S, bool const_iter>
+class WideRangeProxy {
+    public:
+        using Iter = WideIter<B, S, const_iter>;
+        using Base = typename Iter::Base;
+        // start and end are multiples of S
+        WideRangeProxy(Base *data, size_t start, size_t end) :
+            m_data(data), m_start(std::min(start, end)), m_end(end) {}
+
+        auto begin() const { return Iter(m_data, m_start); }
+        auto end() const { return Iter(m_data, m_end); }
+
+    private:
+        Base *m_data;
+        size_t m_start, m_end;
+};
+
+namespace internal {
+
+// Scalar type and lanes of a batch field: a xsimd batch, a std::array of
+// batches (see `wide_t`) or a std::array of scalars.
+template<typename F> struct wide_traits {
+    using value_type = typename F::value_type;
+    static constexpr size_t lanes = F::size;
+};
+template<typename T, typename A, size_t K> struct wide_traits<std::array<xsimd::batch<T, A>, K>> {
+    using value_type = T;
+    static constexpr size_t lanes = K * xsimd::batch<T, A>::size;
+};
+template<typename T, size_t N> struct wide_traits<std::array<T, N>> {
+    using value_type = T;
+    static constexpr size_t lanes = N;
+};
+
+}  // namespace internal
+
+/**
+ * Convert a batch field to scalar type U with the same number of lanes,
+ * returning a `wide_t<U, lanes>`, e.g. the two batch<double> of 8 int32_t
+ * lanes. Lanes are converted as by static_cast; when both types have the
+ * same batch width this is a batch_cast per register.
+ */
+template<typename U, typename F>
+FORCE_INLINE auto convert(const F& field) {
+    using traits = internal::wide_traits<std::remove_cvref_t<F>>;
+    using T = std::remove_cv_t<typename traits::value_type>;
+    constexpr size_t S = traits::lanes;
+    using R = wide_t<U, S>;
+    R result;
+    if constexpr (std::is_same_v<std::remove_cvref_t<F>, wide_t<T, S>> and native_lanes<T> > 1
+            and native_lanes<T> == native_lanes<U>) {
+        for (size_t k = 0; k < result.size(); ++k)
+            result[k] = xsimd::batch_cast<U>(field[k]);
+    }
+    else {
+        alignas(xsimd::default_arch::alignment()) T in[S];
+        alignas(xsimd::default_arch::alignment()) U out[S];
+        if constexpr (requires { field.store_unaligned(in); })
+            field.store_unaligned(in);
+        else if constexpr (native_lanes<T> > 1 and std::is_same_v<std::remove_cvref_t<F>, wide_t<T, S>>)
+            for (size_t k = 0; k < field.size(); ++k)
+                field[k].store_aligned(in + k * native_lanes<T>);
+        else
+            std::copy(field.begin(), field.end(), in);
+        for (size_t j = 0; j < S; ++j)
+            out[j] = static_cast<U>(in[j]);
+        if constexpr (native_lanes<U> > 1 and S % native_lanes<U> == 0)
+            for (size_t k = 0; k < result.size(); ++k)
+                result[k] = xsimd::simd_type<U>::load_aligned(out + k * native_lanes<U>);
+        else
+            std::copy(out, out + S, result.begin());
+    }
+    return result;
+}
+
+}  // namespace aosoa
@@ -0,0 +1,152 @@
+#include "parallel.hpp"
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#pragma once
+
+namespace aosoa {
+
+// Per-thread timing of the last run of a WorkStealingExecutor, in seconds.
+struct WorkStats {
+    std::vector<double> busy, idle;
+    std::vector<size_t> num_tasks, num_steals;
+
+    double total_busy() const { return std::accumulate(busy.begin(), busy.end(), 0.0); }
+
+    // Ratio of the longest to the average busy time, 1 for a perfect balance.
+    double imbalance() const {
+        if (busy.empty()) return 1;
+        double mean = total_busy() / busy.size();
+        return mean > 0 ? *std::max_element(busy.begin(), busy.end()) / mean : 1;
+    }
+};
+
+/**
+ * Runs tasks [0, num_tasks) on a ThreadPool with work stealing. Tasks are
+ * initially dealt to the threads in contiguous blocks. A thread takes tasks
+ * from the back of its own block, and when it runs out, steals the front half
+ * of the largest remaining block of another thread.
+ */
+class WorkStealingExecutor {
+    public:
+        explicit WorkStealingExecutor(ThreadPool& pool = default_thread_pool()) :
+            m_pool(pool), m_queues(std::make_unique<Queue[]>(pool.size())) {}
+
+        size_t num_threads() const { return m_pool.size(); }
+        const WorkStats& stats() const { return m_stats; }
+
+        template<typename Fn>
+        void run(size_t num_tasks, Fn&& fn) {
+            using clock = std::chrono::steady_clock;
+            const size_t nt = num_threads();
+            for (size_t t = 0; t < nt; ++t) {
+                m_queues[t].lo = num_tasks * t / nt;
+                m_queues[t].hi = num_tasks * (t+1) / nt;
+            }
+            m_stats.busy.assign(nt, 0);
+            m_stats.idle.assign(nt, 0);
+            m_stats.num_tasks.assign(nt, 0);
+            m_stats.num_steals.assign(nt, 0);
+
+            auto start = clock::now();
+            m_pool.run(nt, [&, this](size_t t) {
+                std::chrono::duration<double> busy{0};
+                size_t task;
+                while (pop(t, task) or steal(t, task)) {
+                    auto t0 = clock::now();
+                    fn(task);
+                    busy += clock::now() - t0;
+                    ++m_stats.num_tasks[t];
+                }
+                m_stats.busy[t] = busy.count();
+            });
+            std::chrono::duration<double> total = clock::now() - start;
+            for (size_t t = 0; t < nt; ++t)
+                m_stats.idle[t] = std::max(0.0, total.count() - m_stats.busy[t]);
+        }
+
+        /**
+         * Iterate `range<S>()` of the container, then `urange<S>()`, with
+         * frames (or cache line sized chunks of SoaVector) as tasks.
+         */
+        template<size_t S, typename C, typename Fn>
+            requires( S > 0 )
+        void for_each(C& container, Fn&& fn) {
+            constexpr size_t grain = internal::chunk_grain<C, S>();
+            const size_t size = container.size();
+            run((size + grain - 1) / grain, [&](size_t i) {
+                const size_t start = i * grain;
+                internal::for_each_in<S>(container, start, std::min(size, start + grain), fn);
+            });
+        }
+
+        // Same as above, with each container of the list (e.g. one per grid cell) as a task.
+        template<size_t S, typename C, typename Fn>
+            requires( S > 0 )
+        void for_each(std::vector<C>& containers, Fn&& fn) {
+            run(containers.size(), [&](size_t i) {
+                internal::for_each_in<S>(containers[i], 0, containers[i].size(), fn);
+            });
+        }
+
+    private:
+        struct alignas(cache_line_size) Queue {
+            std::mutex mutex;
+            size_t lo = 0, hi = 0;
+        };
+
+        ThreadPool& m_pool;
+        std::unique_ptr<Queue[]> m_queues;
+        WorkStats m_stats;
+
+        bool pop(size_t t, size_t& task) {
+            auto& q = m_queues[t];
+            std::lock_guard lk(q.mutex);
+            if (q.lo == q.hi)
+                return false;
+            task = --q.hi;
+            return true;
+        }
+
+        bool steal(size_t t, size_t& task) {
+            const size_t nt = num_threads();
+            while (true) {
+                // The largest block may be gone before it is locked again, retry then.
+                size_t victim = nt, largest = 0;
+                for (size_t v = 0; v < nt; ++v) {
+                    if (v == t) continue;
+                    auto& q = m_queues[v];
+                    std::lock_guard lk(q.mutex);
+                    if (q.hi - q.lo > largest) {
+                        largest = q.hi - q.lo;
+                        victim = v;
+                    }
+                }
+                if (victim == nt)
+                    return false;
+
+                size_t lo, hi;
+                {
+                    auto& q = m_queues[victim];
+                    std::lock_guard lk(q.mutex);
+                    if (q.lo == q.hi)
+                        continue;
+                    lo = q.lo;
+                    hi = q.lo + (q.hi - q.lo + 1) / 2;
+                    q.lo = hi;
+                }
+                ++m_stats.num_steals[t];
+                task = lo;
+                if (hi - lo > 1) {
+                    auto& q = m_queues[t];
+                    std::lock_guard lk(q.mutex);
+                    q.lo = lo + 1;
+                    q.hi = hi;
+                }
+                return true;
+            }
+        }
+};
+
+}  // namespace aosoa
@@ -0,0 +1,92 @@
+#include "predeclarition.hpp"
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+
+#pragma once
+
+namespace aosoa {
+
+/**
+ * Iterator over several containers in lockstep, yielding a std::tuple of the
+ * elements (or S-batches) of all containers at the same index. Each
+ * container keeps its own iterator, so Aosoa containers still only look up
+ * a frame when crossing a frame boundary; only the first one is compared.
+ */
+template<typename...Iters>
+class ZipIter {
+    public:
+        using difference_type = std::ptrdiff_t;
+        using value_type = void;
+        using iterator_category = std::forward_iterator_tag;
+        using Self = ZipIter<Iters...>;
+
+        FORCE_INLINE ZipIter() = default;
+        FORCE_INLINE ZipIter(Iters...its) : m_its(its...) {}
+
+        FORCE_INLINE auto operator*() const {
+            return std::apply([](const auto&...it) { return std::tuple(*it...); }, m_its);
+        }
+
+        FORCE_INLINE size_t index() const { return std::get<0>(m_its).index(); }
+
+        FORCE_INLINE auto& operator++() {
+            std::apply([](auto&...it) { (++it, ...); }, m_its);
+            return *this;
+        }
+        FORCE_INLINE auto operator++(int) { auto ret = *this; ++(*this); return ret; }
+
+        FORCE_INLINE bool operator==(const Self& other) const { return std::get<0>(m_its) == std::get<0>(other.m_its); }
+
+    private:
+        std::tuple<Iters...> m_its;
+};
+
+template<typename...Iters>
+class ZipRangeProxy {
+    public:
+        using Iter = ZipIter<Iters...>;
+        ZipRangeProxy(ZipIter<Iters...> begin, ZipIter<Iters...> end) : m_begin(begin), m_end(end) {}
+
+        auto begin() const { return m_begin; }
+        auto end() const { return m_end; }
+
+    private:
+        Iter m_begin, m_end;
+};
+
+namespace internal {
+
+template<typename C, typename...Cs>
+void check_zip_sizes(const C& first, const Cs&...cs) {
+    if (not ((cs.size() == first.size()) and ...))
+        throw std::invalid_argument("zipped containers must have the same size");
+}
+
+}  // namespace internal
+
+/**
+ * Iterate over containers of the same size together, e.g.
+ * `for (auto [p, f] : zip_range<S>(particles, forces))`. Like `range<S>()`,
+ * yields the S-batches of the aligned part, the remaining elements being
+ * visited by `zip_urange<S>`. The aligned end is that of the first container,
+ * and the iteration only tests it, so containers of different sizes throw
+ * std::invalid_argument.
+ */
+template<size_t S = 0, typename...Cs>
+    requires( sizeof...(Cs) > 0 )
+auto zip_range(Cs&...cs) {
+    internal::check_zip_sizes(cs...);
+    return ZipRangeProxy(ZipIter(cs.template begin<S>()...), ZipIter(cs.template end<S>()...));
+}
+
+// Single elements after the aligned part of `zip_range<S>`.
+template<size_t S = 0, typename...Cs>
+    requires( sizeof...(Cs) > 0 )
+auto zip_urange(Cs&...cs) {
+    internal::check_zip_sizes(cs...);
+    return ZipRangeProxy(ZipIter(cs.template ubegin<S>()...), ZipIter(cs.template uend<S>()...));
+}
+
+}  // namespace aosoa
@@ -0,0 +1,73 @@
+#include "../aosoa/aosoa.hpp"
+#include <iostream>
+#include <cstdint>
+#include <random>
+
+using namespace std;
+
+SOA_DEFINE_ELEM(pos);
+SOA_DEFINE_ELEM(cell);
+SOA_DEFINE_ELEM(id);
+
+using Types = std::tuple<
+        pos<double, 2>,
+        cell<int32_t>,
+        id<int64_t>>;
+
+constexpr size_t num_dbl = aosoa::simd_width / sizeof(double);
+
+using bucket_t = aosoa::AosoaList<Types, 4*num_dbl>;
+
+template<typename Arr>
+bool test(size_t size, size_t num_cells, aosoa::ThreadPool& pool) {
+    std::mt19937 gen(size);
+    std::uniform_int_distribution<size_t> dist(0, num_cells-1);
+
+    // buckets already holding some particles
+    std::vector<bucket_t> cells(num_cells);
+    int64_t i = 0;
+    for (size_t c = 0; c < num_cells; ++c) {
+        cells[c].resize(c % 7);
+        for (auto p : cells[c]) {
+            p.cell() = c;
+            p.id() = i++;
+        }
+    }
+    const int64_t num_old = i;
+
+    Arr pa;
+    pa.resize(size);
+    for (auto p : pa) {
+        p.cell() = dist(gen);
+        p.id() = i;
+        tpa::assign(p.pos(), double(i));
+        ++i;
+    }
+
+    aosoa::bin(pa, [](auto p) { return p.cell(); }, cells, pool);
+
+    if (pa.size() != 0)
+        return false;
+    std::vector<int> seen(i, 0);
+    for (size_t c = 0; c < num_cells; ++c) {
+        for (auto p : cells[c]) {
+            if (p.cell() != int32_t(c) or (p.id() >= num_old and get<1>(p.pos()) != p.id()))
+                return false;
+            ++seen[p.id()];
+        }
+    }
+    return std::all_of(seen.begin(), seen.end(), [](int s) { return s == 1; });
+}
+
+int main() {
+    aosoa::ThreadPool pool(4);
+    bool ok = true;
+    for (size_t size : {0, 1, 100, 4099, 50000}) {
+        for (size_t num_cells : {1, 3, 100}) {
+            ok = ok and test<bucket_t>(size, num_cells, pool);
+            ok = ok and test<aosoa::AosoaVector<Types, 3*num_dbl>>(size, num_cells, pool);
+            ok = ok and test<aosoa::SoaVector<Types>>(size, num_cells, pool);
+        }
+    }
+    cout << "Binning: " << (ok ? "OK" : "ERROR") << endl;
+}
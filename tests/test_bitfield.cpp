@@ -0,0 +1,79 @@
+#include "../aosoa/aosoa.hpp"
+#include <bit>
+#include <cstdint>
+#include <iostream>
+
+using namespace std;
+
+SOA_DEFINE_ELEM(pos);
+SOA_DEFINE_ELEM(state);
+
+using Types = std::tuple<
+        pos<double>,
+        state<uint8_t>>;
+
+using alive = aosoa::bitfield<0>;
+using tracked = aosoa::bitfield<1>;
+using species = aosoa::bitfield<2, 3>;
+
+constexpr size_t num_dbl = aosoa::simd_width / sizeof(double);
+
+template<typename Arr>
+bool test(Arr& pa) {
+    const size_t size = pa.size();
+    size_t i = 0;
+    for (auto p : pa) {
+        p.pos() = double(i);
+        p.state() = 0;
+        aosoa::deposit<alive>(p.state(), i % 3 != 0);
+        aosoa::deposit<species>(p.state(), i % 5);
+        ++i;
+    }
+
+    size_t num_alive = 0;
+    for (auto p : pa.template range<num_dbl>()) {
+        const auto m = aosoa::flag_mask<double, alive>(p.state());
+        num_alive += std::popcount(uint64_t(m.mask()));
+        aosoa::deposit<tracked>(p.state(), m);
+        const auto s = aosoa::extract<species>(p.state());
+        using B = std::remove_cvref_t<decltype(s)>;
+        aosoa::deposit<species>(p.state(), xsimd::select(s == B(4), B(0), s + B(1)));
+    }
+    for (size_t k = size / num_dbl * num_dbl; k < size; ++k) {
+        auto p = pa[k];
+        const bool a = aosoa::extract<alive>(p.state());
+        num_alive += a;
+        aosoa::deposit<tracked>(p.state(), a);
+        aosoa::deposit<species>(p.state(), (aosoa::extract<species>(p.state()) + 1) % 5);
+    }
+
+    size_t expected_alive = 0;
+    i = 0;
+    for (auto p : pa) {
+        const bool a = i % 3 != 0;
+        expected_alive += a;
+        if (aosoa::extract<alive>(p.state()) != a or aosoa::extract<tracked>(p.state()) != a)
+            return false;
+        if (aosoa::extract<species>(p.state()) != (i % 5 + 1) % 5 or p.pos() != double(i))
+            return false;
+        ++i;
+    }
+    return i == size and num_alive == expected_alive;
+}
+
+int main() {
+    static_assert(aosoa::SoaVector<Types>::elem_size == sizeof(double) + 1);
+    bool ok = true;
+    for (size_t size : {0, 1, 100, 4099}) {
+        aosoa::AosoaVector<Types, 8*num_dbl> a;
+        a.resize(size);
+        ok = ok and test(a);
+        aosoa::AosoaList<Types, 4*num_dbl> b;
+        b.resize(size);
+        ok = ok and test(b);
+        aosoa::SoaVector<Types> c;
+        c.resize(size);
+        ok = ok and test(c);
+    }
+    cout << "Bit fields: " << (ok ? "OK" : "ERROR") << endl;
+}
@@ -0,0 +1,76 @@
+#include "../aosoa/aosoa.hpp"
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <span>
+
+using namespace std;
+
+SOA_DEFINE_ELEM(pos);
+SOA_DEFINE_ELEM(vel);
+SOA_DEFINE_ELEM(id);
+
+using Types = std::tuple<
+        pos<double, 3>,
+        id<int32_t>,
+        vel<float, 3>>;
+
+constexpr size_t num_dbl = aosoa::simd_width / sizeof(double);
+
+// y += a * x, the way a hand-written or BLAS-like kernel sees a column
+void axpy(size_t n, double a, const double* __restrict x, double* __restrict y) {
+    for (size_t k = 0; k < n; ++k)
+        y[k] += a * x[k];
+}
+
+template<typename Arr>
+bool test(size_t size) {
+    Arr pa;
+    pa.resize(size);
+    int32_t i = 0;
+    for (auto p : pa) {
+        p.pos() = std::tuple(double(i), 1., 2.);
+        p.vel() = std::tuple(0.5f, float(i), 0.f);
+        p.id() = i++;
+    }
+
+    auto x = pa.template column<pos>();
+    auto z = pa.template column<pos, 2>();
+    auto ids = std::as_const(pa).template column<id>();
+    static_assert(std::is_const_v<std::remove_reference_t<decltype(ids[0])>>);
+
+    bool ok = x.size() == size and ids.size() == size;
+    if constexpr (requires { x.num_frames(); }) {
+        ok = ok and x.num_frames() == pa.num_frames();
+        for (size_t f = 0; f < x.num_frames(); ++f) {
+            ok = ok and x.frame(f).size() == std::min(x.frame_size, size - f * x.frame_size);
+            axpy(x.frame(f).size(), 2., z.frame_data(f), x.frame_data(f));
+        }
+    }
+    else
+        axpy(x.size(), 2., z.data(), x.data());
+
+    // x = i + 4, through the element iterators as well
+    ok = ok and std::equal(ids.begin(), ids.end(), x.begin(), [](int32_t a, double b) { return a + 4. == b; });
+    ok = ok and std::accumulate(ids.begin(), ids.end(), int64_t(0)) == int64_t(size) * (int64_t(size) - 1) / 2;
+    i = 0;
+    for (auto p : pa)
+        ok = ok and get<0>(p.pos()) == i + 4. and get<2>(p.pos()) == 2. and p.id() == i++;
+
+    auto vy = pa.template column<vel, 1>();
+    std::fill(vy.begin(), vy.end(), 3.f);
+    for (size_t k = 0; k < size; ++k)
+        ok = ok and get<1>(pa[k].vel()) == 3.f and get<0>(pa[k].vel()) == 0.5f;
+    return ok;
+}
+
+int main() {
+    bool ok = true;
+    for (size_t size : {0, 1, 7, 100, 4099}) {
+        ok = ok and test<aosoa::SoaVector<Types>>(size);
+        ok = ok and test<aosoa::AosoaVector<Types, 4*num_dbl>>(size);
+        ok = ok and test<aosoa::AosoaVector<Types, 2*num_dbl, aosoa::default_align, true>>(size);
+    }
+    cout << "Columns: " << (ok ? "OK" : "ERROR") << endl;
+}
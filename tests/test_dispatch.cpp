@@ -0,0 +1,66 @@
+#include "../aosoa/aosoa.hpp"
+#include <iostream>
+#include <cstdint>
+
+using namespace std;
+
+SOA_DEFINE_ELEM(pos);
+SOA_DEFINE_ELEM(vel);
+
+using Types = std::tuple<
+        pos<double, 2>,
+        vel<double, 2>>;
+
+// Every architecture compiled in this translation unit, so that the kernel
+// can be instantiated here instead of in per-architecture translation units.
+using Archs = xsimd::supported_architectures;
+
+struct Push {
+    double dt;
+
+    template<typename Arch, typename C>
+    void operator()(Arch, C& pa, size_t start, size_t end) const {
+        constexpr size_t S = aosoa::arch_lanes<Arch, double>;
+        for (auto p : pa.template range<S>(start, end)) {
+            auto x = aosoa::load_as<Arch>(get<0>(p.pos()));
+            auto v = aosoa::load_as<Arch>(get<0>(p.vel()));
+            aosoa::store_as(get<0>(p.pos()), x + dt * v);
+        }
+        for (auto p : pa.template urange<S>(start, end))
+            tpa::assign(get<0>(p.pos()), get<0>(p.pos()) + dt * get<0>(p.vel()));
+    }
+};
+
+template<typename Arr>
+bool test(size_t size, aosoa::ThreadPool& pool) {
+    Arr pa;
+    pa.resize(size);
+    int64_t i = 0;
+    for (auto p : pa) {
+        tpa::assign(p.pos(), double(i));
+        tpa::assign(p.vel(), 2.);
+        ++i;
+    }
+    aosoa::dispatch_for_chunks<double, Archs>(pa, Push{0.5}, pool);
+    i = 0;
+    for (auto p : pa) {
+        if (get<0>(p.pos()) != i + 1. or get<1>(p.pos()) != double(i))
+            return false;
+        ++i;
+    }
+    return true;
+}
+
+int main() {
+    aosoa::ThreadPool pool(4);
+    bool ok = aosoa::dispatched_arch_index<Archs>() < 64;
+    constexpr size_t frame = 64 / sizeof(double);  // lanes of the widest architecture
+    for (size_t size : {0, 1, 100, 4099}) {
+        ok = ok and test<aosoa::AosoaVector<Types, 4*frame>>(size, pool);
+        ok = ok and test<aosoa::AosoaList<Types, 2*frame>>(size, pool);
+        ok = ok and test<aosoa::SoaVector<Types>>(size, pool);
+    }
+    int r = aosoa::dispatch<Archs>([](auto arch) { return int(aosoa::arch_lanes<decltype(arch), double>); });
+    ok = ok and r >= 1;
+    cout << "Dispatch: " << (ok ? "OK" : "ERROR") << endl;
+}
@@ -0,0 +1,84 @@
+#include "../aosoa/aosoa.hpp"
+#include <iostream>
+#include <cstdint>
+#include <stdexcept>
+
+using namespace std;
+
+SOA_DEFINE_ELEM(pos);
+SOA_DEFINE_ELEM(vel);
+SOA_DEFINE_ELEM(force);
+SOA_DEFINE_ELEM(mass);
+
+using Types = std::tuple<
+        pos<double, 3>,
+        vel<double, 3>,
+        force<double, 3>,
+        mass<double>>;
+
+constexpr size_t num_dbl = aosoa::simd_width / sizeof(double);
+
+template<typename Arr>
+bool test(Arr& pa, aosoa::ThreadPool& pool) {
+    const size_t size = pa.size();
+    int64_t i = 0;
+    for (auto p : pa) {
+        tpa::assign(p.pos(), double(i));
+        tpa::assign(p.vel(), 1.);
+        p.force() = std::tuple(double(i), 2., 3.);
+        p.mass() = 2.;
+        ++i;
+    }
+
+    const double dt = 0.5;
+    // one statement, evaluated by fuse only
+    auto stmt = pa.template col<pos>() += dt * pa.template col<vel>();
+    aosoa::fuse(pool, stmt);
+    // two statements in one pass, the second one seeing the new velocity
+    aosoa::fuse(pool,
+            pa.template col<vel>() += dt * pa.template col<force>() / pa.template col<mass>(),
+            pa.template col<pos>() += dt * pa.template col<vel>());
+    aosoa::fuse(pool, pa.template col<mass>() = -pa.template col<mass>() + 1.);
+
+    // fields of another container are rejected
+    Arr other;
+    try {
+        aosoa::fuse(pool, pa.template col<pos>() += other.template col<vel>());
+        return false;
+    }
+    catch (const std::invalid_argument&) {}
+
+    i = 0;
+    for (auto p : pa) {
+        auto [x, y, z] = p.pos();
+        auto [vx, vy, vz] = p.vel();
+        const double v0 = 1 + 0.25 * i;
+        if (vx != v0 or vy != 1.5 or vz != 1.75)
+            return false;
+        if (x != i + 0.5 + 0.5 * v0 or y != i + 0.5 + 0.75 or z != i + 0.5 + 0.875)
+            return false;
+        if (p.mass() != -1.)
+            return false;
+        ++i;
+    }
+    return size_t(i) == size;
+}
+
+int main() {
+    aosoa::ThreadPool pool(4);
+    bool ok = true;
+    for (size_t size : {0, 1, 100, 4099}) {
+        aosoa::AosoaVector<Types, 4*num_dbl> a;
+        a.resize(size);
+        ok = ok and test(a, pool);
+        aosoa::AosoaList<Types, 3*num_dbl> b;
+        b.resize(size);
+        ok = ok and test(b, pool);
+        aosoa::SoaVector<Types> c;
+        c.resize(size);
+        ok = ok and test(c, pool);
+    }
+    aosoa::SoaArray<Types, 32> d;
+    ok = ok and test(d, pool);
+    cout << "Expressions: " << (ok ? "OK" : "ERROR") << endl;
+}
@@ -0,0 +1,59 @@
+#include "../aosoa/aosoa.hpp"
+#include <iostream>
+#include <algorithm>
+
+using namespace std;
+
+SOA_DEFINE_ELEM(pos);
+SOA_DEFINE_ELEM(vel);
+
+using Types = std::tuple<
+        pos<double>,
+        vel<double, 3>>;
+
+constexpr size_t num_dbl = aosoa::simd_width / sizeof(double);
+
+// frame size not a power of 2
+using particle_arr = aosoa::AosoaList<Types, 3*num_dbl>;
+
+int main() {
+    particle_arr pa;
+    pa.resize(53);
+
+    int i = 0;
+    for (auto p : pa)
+        p.pos() = 53 - i++;
+
+    std::sort(pa.begin(), pa.end(),
+            [](auto p1, auto p2) { return p1.pos() < p2.pos(); });
+
+    bool ok = std::is_sorted(pa.begin(), pa.end(),
+            [](auto p1, auto p2) { return p1.pos() < p2.pos(); });
+    cout << "Sorted: " << (ok ? "OK" : "ERROR") << endl;
+
+    // walk backward across frames
+    i = 53;
+    for (auto it = pa.end(); it != pa.begin();) {
+        --it;
+        if ((*it).pos() != i--)
+            ok = false;
+    }
+    cout << "Reverse: " << (ok ? "OK" : "ERROR") << endl;
+
+    size_t total = 0, frames = 0;
+    pa.for_each_frame([&](auto& frame, size_t num) {
+        for (auto p : frame.template range<num_dbl>())
+            tpa::assign(p.vel(), frames);
+        total += num;
+        ++frames;
+    });
+    cout << "Frames: " << frames << ", elements: " << total << endl;
+    // Print:
+    // Frames: 3, elements: 53   (for avx512)
+    // Frames: 5, elements: 53   (for avx2)
+    // Frames: 9, elements: 53   (for SSE2)
+
+    for (auto p : pa.range<num_dbl>())
+        cout << get<0>(p.vel()).get(0) << " ";
+    cout << endl;
+}
@@ -0,0 +1,104 @@
+#include "../aosoa/aosoa.hpp"
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+SOA_DEFINE_ELEM(pos);
+SOA_DEFINE_ELEM(id);
+
+using Types = std::tuple<
+        pos<double, 3>,
+        id<int64_t>>;
+
+constexpr size_t num_dbl = aosoa::simd_width / sizeof(double);
+
+using List = aosoa::AosoaList<Types, 2*num_dbl>;
+
+// frames taken from the pool by the cells
+size_t held(const vector<List>& cells) {
+    size_t num = 0;
+    for (auto& c : cells)
+        num += c.data().size();
+    return num;
+}
+
+// every id in [0, num) once
+bool all_ids(const vector<List>& cells, int64_t num) {
+    vector<int> count(num, 0);
+    size_t total = 0;
+    for (auto& c : cells) {
+        for (auto p : c) {
+            if (p.id() < 0 or p.id() >= num)
+                return false;
+            count[p.id()] += 1;
+        }
+        total += c.size();
+    }
+    return total == size_t(num) and std::all_of(count.begin(), count.end(), [](int n) { return n == 1; });
+}
+
+bool test(size_t num_cells, aosoa::ThreadPool& threads) {
+    List::Pool pool(4);
+    vector<List> cells;
+    for (size_t c = 0; c < num_cells; ++c)
+        cells.emplace_back(&pool);
+
+    int64_t num = 0;
+    for (size_t c = 0; c < num_cells; ++c) {
+        for (size_t k = 0; k < (c + 1) * 37 % 101; ++k) {
+            auto p = cells[c].emplace_back();
+            p.pos() = std::tuple(1., 2., 3.);
+            p.id() = num++;
+        }
+    }
+    bool ok = all_ids(cells, num) and pool.capacity() - pool.num_free() == held(cells);
+
+    // migration between cells recycles frames through the pool
+    for (size_t round = 0; round < 5; ++round) {
+        for (size_t c = 0; c < num_cells; ++c) {
+            auto& from = cells[c];
+            auto& to = cells[(c + round + 1) % num_cells];
+            if (&from != &to)
+                to.move_merge(to.size(), from.size() / 2, from);
+        }
+        ok = ok and all_ids(cells, num) and pool.capacity() - pool.num_free() == held(cells);
+    }
+
+    // emptied lists give back all their frames, and refilling them takes no new slab
+    const size_t capacity = pool.capacity();
+    vector<size_t> sizes;
+    for (auto& c : cells) {
+        sizes.push_back(c.size());
+        c.clear();
+    }
+    ok = ok and pool.num_free() == capacity;
+    for (size_t c = 0; c < num_cells; ++c)
+        cells[c].resize(sizes[c]);
+    ok = ok and pool.capacity() == capacity and pool.capacity() - pool.num_free() == held(cells);
+
+    // and concurrently, from threads of their own shards
+    threads.run(num_cells, [&](size_t c) { cells[c].clear(); cells[c].resize(sizes[c]); });
+    ok = ok and pool.capacity() - pool.num_free() == held(cells);
+    for (auto& c : cells)
+        for (auto p : c)
+            ok = ok and p.id() == 0 and get<2>(p.pos()) == 0.;
+
+    // frames from the heap and from the pool can be mixed
+    List heap;
+    heap.resize(3 * num_dbl + 1);
+    cells[0].move_merge(cells[0].size(), 0, heap);
+    ok = ok and heap.size() == 0 and cells[0].size() == sizes[0] + 3 * num_dbl + 1;
+    cells.clear();
+    return ok and pool.num_free() == pool.capacity();
+}
+
+int main() {
+    aosoa::ThreadPool threads(4);
+    bool ok = true;
+    for (size_t num_cells : {1, 2, 16, 100})
+        ok = ok and test(num_cells, threads);
+    cout << "Frame pool: " << (ok ? "OK" : "ERROR") << endl;
+}
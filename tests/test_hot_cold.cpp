@@ -0,0 +1,106 @@
+#include "../aosoa/aosoa.hpp"
+#include <iostream>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+SOA_DEFINE_ELEM(pos);
+SOA_DEFINE_ELEM(vel);
+SOA_DEFINE_ELEM(id);
+SOA_DEFINE_ELEM(birth);
+
+using Hot = std::tuple<
+        pos<double, 2>,
+        vel<double, 2>>;
+using Cold = std::tuple<
+        id<int64_t>,
+        birth<double>>;
+
+constexpr size_t num_dbl = aosoa::simd_width / sizeof(double);
+
+template<typename Arr>
+bool check(const Arr& pa, int64_t stride) {
+    int64_t k = 0;
+    for (auto p : pa) {
+        const int64_t i = p.id();
+        if (i != k * stride or p.birth() != -double(i) or get<0>(p.pos()) != i + 0.5 * i or get<1>(p.vel()) != 1.)
+            return false;
+        ++k;
+    }
+    return true;
+}
+
+template<typename Arr>
+bool test(size_t size) {
+    Arr pa;
+    pa.resize(size);
+    int64_t i = 0;
+    for (auto p : pa) {
+        p.pos() = std::tuple(double(i), 0.);
+        p.vel() = std::tuple(0.5 * i, 1.);
+        p.id() = i;
+        p.birth() = -double(i);
+        ++i;
+    }
+    static_assert(Arr::elem_size == 5 * sizeof(double) + sizeof(int64_t));
+
+    // a kernel over the hot fields, through the whole container and through the hot part
+    for (auto p : pa.template range<num_dbl>())
+        tpa::assign(get<0>(p.pos()), get<0>(p.pos()) + get<0>(p.vel()));
+    for (auto p : pa.hot().template urange<num_dbl>())
+        tpa::assign(get<0>(p.pos()), get<0>(p.pos()) + get<0>(p.vel()));
+    bool ok = check(pa, 1);
+
+    // serialization carries both parts
+    if (size > 0) {
+        vector<char> buf(pa.serialize_size(0, size));
+        pa.serialize(0, size, buf.data());
+        Arr pb;
+        pb.deserialize(0, buf.data());
+        ok = ok and pb.size() == size and check(pb, 1);
+    }
+
+    // sorting and compaction move hot and cold fields together
+    aosoa::sort_by_key(pa, [](auto p) { return -p.id(); });
+    i = int64_t(size);
+    for (auto p : pa)
+        ok = ok and p.id() == --i and get<0>(p.pos()) == i + 0.5 * i;
+    aosoa::sort_by_key(pa, [](auto p) { return p.id(); });
+    aosoa::remove_if<num_dbl>(pa, [](auto p) {
+        return xsimd::floor(p.birth() * 0.5) * 2. != p.birth();
+    });
+    ok = ok and pa.size() == (size + 1) / 2 and check(pa, 2);
+    return ok;
+}
+
+bool test_merge(size_t size1, size_t size2) {
+    aosoa::HotColdList<Hot, Cold, 2*num_dbl> pa1, pa2;
+    pa1.resize(size1);
+    pa2.resize(size2);
+    int64_t i = 0;
+    for (auto p : pa1)
+        p.id() = i++;
+    for (auto p : pa2) {
+        p.id() = i++;
+        p.pos() = std::tuple(double(p.id()), 0.);
+    }
+    pa1.move_merge(size1, 0, pa2);
+    i = 0;
+    for (auto p : pa1) {
+        if (p.id() != i or (size_t(i) >= size1 and get<0>(p.pos()) != double(i)))
+            return false;
+        ++i;
+    }
+    return size_t(i) == size1 + size2 and pa2.size() == 0;
+}
+
+int main() {
+    bool ok = true;
+    for (size_t size : {0, 1, 100, 4099}) {
+        ok = ok and test<aosoa::HotColdVector<Hot, Cold, 4*num_dbl>>(size);
+        ok = ok and test<aosoa::HotColdList<Hot, Cold, 3*num_dbl>>(size);
+    }
+    ok = ok and test_merge(5, 30) and test_merge(40, 3) and test_merge(1, 17);
+    cout << "Hot/cold: " << (ok ? "OK" : "ERROR") << endl;
+}
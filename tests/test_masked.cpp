@@ -0,0 +1,109 @@
+#include "../aosoa/aosoa.hpp"
+#include <iostream>
+#include <cstdint>
+
+using namespace std;
+
+SOA_DEFINE_ELEM(pos);
+SOA_DEFINE_ELEM(id);
+
+using Types = std::tuple<
+        pos<double, 2>,
+        id<int64_t>>;
+
+constexpr size_t num_dbl = aosoa::simd_width / sizeof(double);
+
+template<typename Arr>
+bool test_full(size_t size) {
+    Arr pa;
+    pa.resize(size);
+    int i = 0;
+    for (auto p : pa)
+        p.id() = i++;
+
+    // One kernel for the whole container, tail included.
+    double sum = 0;
+    for (auto p : pa.template mrange<num_dbl>()) {
+        using batch_t = xsimd::make_sized_batch_t<double, num_dbl>;
+        tpa::assign(p.pos(), xsimd::batch_cast<double>(p.id()) + 1.);
+        sum += xsimd::reduce_add(xsimd::select(p.mask(), get<0>(p.pos()), batch_t(0.)));
+    }
+
+    i = 0;
+    for (auto p : pa) {
+        if (get<0>(p.pos()) != i+1 or get<1>(p.pos()) != i+1)
+            return false;
+        ++i;
+    }
+    return sum == size * (size+1) / 2;
+}
+
+template<typename Arr>
+bool test_ranged(size_t size, size_t start, size_t end) {
+    Arr pa;
+    pa.resize(size);
+    for (auto p : pa)
+        tpa::assign(p.pos(), -1);
+
+    for (auto p : pa.template mrange<num_dbl>(start, end))
+        tpa::assign(p.pos(), 1);
+
+    size_t i = 0;
+    for (auto p : pa) {
+        double expected = (i >= start and i < end) ? 1 : -1;
+        if (get<0>(p.pos()) != expected or get<1>(p.pos()) != expected)
+            return false;
+        ++i;
+    }
+    return true;
+}
+
+// A full batch at any index, possibly across frames, writes its lanes only.
+template<typename Arr>
+bool test_unaligned(size_t size, size_t start) {
+    Arr pa;
+    pa.resize(size);
+    for (auto p : pa)
+        tpa::assign(p.pos(), -1);
+    if (start + num_dbl > size)
+        return true;
+    {
+        auto p = pa.template get_masked<num_dbl>(start, num_dbl);
+        tpa::assign(p.pos(), 2);
+    }
+    size_t i = 0;
+    for (auto p : pa) {
+        double expected = (i >= start and i < start + num_dbl) ? 2 : -1;
+        if (get<0>(p.pos()) != expected or get<1>(p.pos()) != expected)
+            return false;
+        ++i;
+    }
+    return true;
+}
+
+int main() {
+    using vec_t = aosoa::AosoaVector<Types, 4*num_dbl>;
+    using list_t = aosoa::AosoaList<Types, 4*num_dbl>;
+    using soa_t = aosoa::SoaVector<Types>;
+
+    const size_t test_num = 2000;
+    bool ok = true;
+    for (auto i = 0; i < test_num and ok; ++i) {
+        size_t size = rand() % 100 + 1;
+        size_t start = rand() % size;
+        size_t end = start + rand() % (size - start + 1);
+        ok = test_full<vec_t>(size) and test_full<list_t>(size) and test_full<soa_t>(size) and
+            test_ranged<vec_t>(size, start, end) and test_ranged<list_t>(size, start, end) and
+            test_ranged<soa_t>(size, start, end) and test_unaligned<vec_t>(size, start) and
+            test_unaligned<list_t>(size, start) and test_unaligned<soa_t>(size, start);
+        if (!ok)
+            cerr << "ERROR: " << size << " " << start << " " << end << endl;
+    }
+    if (ok)
+        cerr << "Tested " << test_num << " cases, All OK" << endl;
+
+    soa_t pa;
+    pa.resize(3);
+    auto p = pa.get_masked<num_dbl>(0, 3);
+    cout << "Mask of 3 active lanes: " << p.bits() << endl;
+}
@@ -0,0 +1,79 @@
+#include "../aosoa/aosoa.hpp"
+#include <iostream>
+#include <cstdint>
+
+using namespace std;
+
+SOA_DEFINE_ELEM(pos);
+SOA_DEFINE_ELEM(vel);
+SOA_DEFINE_ELEM(id);
+
+using Types = std::tuple<
+        vel<double, 3>,
+        id<int32_t>,
+        pos<double, 1>>;
+
+constexpr size_t num_dbl = aosoa::simd_width / sizeof(double);
+
+// 7 elements per frame: neither the int nor the double arrays end on an alignment boundary.
+using packed_frame = aosoa::SoaArray<Types, 7*num_dbl>;
+using padded_frame = aosoa::SoaArray<Types, 7*num_dbl, aosoa::simd_width, true>;
+
+template<typename Frame>
+void print_simd_components() {
+    tpa::constexpr_for<0, std::tuple_size_v<typename Frame::Data>, 1>([](auto I) {
+        constexpr size_t i = decltype(I)::value;
+        cout << Frame::template is_simd_component<i, num_dbl>() << " ";
+    });
+    cout << endl;
+}
+
+bool test_serialize() {
+    using particle_arr = aosoa::AosoaVector<Types, 7*num_dbl, aosoa::simd_width, true>;
+    particle_arr pa, pb;
+    pa.resize(100);
+    int i = 0;
+    for (auto p : pa) {
+        p.id() = i;
+        get<0>(p.pos()) = i++;
+    }
+
+    vector<char> buf(pa.serialize_size(3, 97));
+    pa.serialize(3, 97, buf.data());
+    pb.deserialize(0, buf.data());
+
+    // deserialize does not keep the order, check each element appears once.
+    vector<int> flag(100, 0);
+    for (auto p : pb) {
+        if (p.id() != int(get<0>(p.pos())))
+            return false;
+        flag[p.id()] += 1;
+    }
+    for (auto i = 0; i < 100; ++i)
+        if (flag[i] != (i >= 3 and i < 97))
+            return false;
+    return true;
+}
+
+int main() {
+    cout << "packed: ";
+    print_simd_components<packed_frame>();
+    cout << "padded: ";
+    print_simd_components<padded_frame>();
+    // For any instruction set, print:
+    // padded: 1 1 1 1 1
+
+    cout << "sizeof packed: " << sizeof(packed_frame) << ", padded: " << sizeof(padded_frame) << endl;
+
+    padded_frame frame;
+    int i = 0;
+    for (auto p : frame.range<num_dbl>()) {
+        tpa::assign(p.pos(), ++i);
+        tpa::assign(p.id(), i);
+    }
+    for (auto p : frame)
+        cout << get<0>(p.pos()) << "," << p.id() << " ";
+    cout << endl;
+
+    cout << "Serialize padded: " << (test_serialize() ? "OK" : "ERROR") << endl;
+}
@@ -0,0 +1,66 @@
+#include "../aosoa/aosoa.hpp"
+#include <iostream>
+#include <atomic>
+
+using namespace std;
+
+SOA_DEFINE_ELEM(pos);
+SOA_DEFINE_ELEM(vel);
+
+using Types = std::tuple<
+        pos<double, 3>,
+        vel<double, 3>>;
+
+constexpr size_t num_dbl = aosoa::simd_width / sizeof(double);
+
+template<typename Arr, size_t S = num_dbl>
+bool test_pa(size_t size, aosoa::ThreadPool& pool) {
+    Arr pa;
+    pa.resize(size);
+    int i = 0;
+    for (auto p : pa) {
+        tpa::assign(p.pos(), i++);
+        tpa::assign(p.vel(), 1);
+    }
+
+    // x += dt * v
+    aosoa::parallel_for_each<S>(pa, [](auto p) {
+        tpa::assign(p.pos(), p.pos() + 0.5 * p.vel());
+    }, pool);
+
+    i = 0;
+    for (auto p : pa) {
+        if (get<0>(p.pos()) != i + 0.5 or get<2>(p.pos()) != i + 0.5)
+            return false;
+        ++i;
+    }
+
+    // Chunks must cover the container exactly once, starting on frame/batch boundaries.
+    std::atomic<size_t> covered = 0;
+    std::atomic<bool> aligned = true;
+    aosoa::parallel_for_chunks<num_dbl>(pa, [&](size_t start, size_t end) {
+        covered += end - start;
+        if (start % num_dbl != 0)
+            aligned = false;
+    }, pool);
+    return covered == size and aligned;
+}
+
+int main() {
+    aosoa::ThreadPool pool(4);
+    cout << "Threads: " << pool.size() << endl;
+
+    const size_t test_num = 200;
+    bool ok = true;
+    for (auto i = 0; i < test_num and ok; ++i) {
+        size_t size = rand() % 10000;
+        ok = test_pa<aosoa::AosoaVector<Types, 8*num_dbl>>(size, pool) and
+             test_pa<aosoa::AosoaList<Types, 8*num_dbl>>(size, pool) and
+             test_pa<aosoa::SoaVector<Types>>(size, pool) and
+             test_pa<aosoa::AosoaList<Types, 3*num_dbl>, 2*num_dbl>(size, pool);
+        if (!ok)
+            cerr << "ERROR: " << size << endl;
+    }
+    if (ok)
+        cerr << "Tested " << test_num << " cases, All OK" << endl;
+}
@@ -0,0 +1,63 @@
+#include "../aosoa/aosoa.hpp"
+#include <iostream>
+#include <cstdint>
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+using namespace std;
+
+SOA_DEFINE_ELEM(pos);
+SOA_DEFINE_ELEM(id);
+
+using Types = std::tuple<
+        pos<double, 3>,
+        id<int64_t>>;
+
+constexpr size_t num_dbl = aosoa::simd_width / sizeof(double);
+
+template<typename Arr>
+bool test(Arr& pa, aosoa::PermuteMode mode, aosoa::ThreadPool& pool) {
+    const size_t size = pa.size();
+    int64_t i = 0;
+    for (auto p : pa) {
+        p.id() = i;
+        tpa::assign(p.pos(), double(i));
+        ++i;
+    }
+
+    std::vector<size_t> perm(size);
+    std::iota(perm.begin(), perm.end(), 0);
+    std::shuffle(perm.begin(), perm.end(), std::mt19937(size));
+
+    aosoa::apply_permutation(pa, perm, mode, pool);
+
+    for (size_t k = 0; k < size; ++k) {
+        auto p = pa[k];
+        if (p.id() != int64_t(perm[k]) or get<0>(p.pos()) != perm[k] or get<2>(p.pos()) != perm[k])
+            return false;
+    }
+    return true;
+}
+
+template<typename Arr>
+bool test_resizable(size_t size, aosoa::PermuteMode mode, aosoa::ThreadPool& pool) {
+    Arr pa;
+    pa.resize(size);
+    return test(pa, mode, pool);
+}
+
+int main() {
+    aosoa::ThreadPool pool(4);
+    bool ok = true;
+    for (auto mode : {aosoa::PermuteMode::gather, aosoa::PermuteMode::in_place}) {
+        for (size_t size : {0, 1, 2, 100, 4099, 50000}) {
+            ok = ok and test_resizable<aosoa::AosoaVector<Types, 4*num_dbl>>(size, mode, pool);
+            ok = ok and test_resizable<aosoa::AosoaList<Types, 3*num_dbl>>(size, mode, pool);
+            ok = ok and test_resizable<aosoa::SoaVector<Types>>(size, mode, pool);
+        }
+        aosoa::SoaArray<Types, 8*num_dbl> arr;
+        ok = ok and test(arr, mode, pool);
+    }
+    cout << "apply_permutation: " << (ok ? "OK" : "ERROR") << endl;
+}
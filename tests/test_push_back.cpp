@@ -0,0 +1,108 @@
+#include "../aosoa/aosoa.hpp"
+#include <iostream>
+#include <cstdint>
+
+using namespace std;
+
+SOA_DEFINE_ELEM(pos);
+SOA_DEFINE_ELEM(id);
+SOA_DEFINE_ELEM(mass);
+
+using Types = std::tuple<
+        pos<double, 2>,
+        id<int32_t>,
+        mass<float>>;
+
+constexpr size_t num_dbl = aosoa::simd_width / sizeof(double);
+
+template<typename Arr>
+bool same(const Arr& pa, size_t size, int32_t first) {
+    bool ok = pa.size() == size;
+    int32_t i = first;
+    for (auto p : pa) {
+        ok = ok and get<0>(p.pos()) == double(i) and get<1>(p.pos()) == -double(i)
+                and p.id() == i and p.mass() == 0.5f * float(i);
+        ++i;
+    }
+    return ok;
+}
+
+template<typename Arr>
+bool test(size_t size) {
+    // emplace_back fills the new elements in place
+    Arr src;
+    src.reserve(size);
+    for (size_t k = 0; k < size; ++k) {
+        auto p = src.emplace_back();
+        p.pos() = std::tuple(double(k), -double(k));
+        p.id() = int32_t(k);
+        p.mass() = 0.5f * float(k);
+    }
+    bool ok = same(src, size, 0);
+
+    // element by element, from references and from a SoaElem
+    Arr pa;
+    for (size_t k = 0; k < size; ++k) {
+        if (k % 2)
+            pa.push_back(src[k]);
+        else
+            pa.push_back(aosoa::soa::SoaElem<Types>(src[k]));
+    }
+    ok = ok and same(pa, size, 0);
+
+    // by batches from src, at aligned ends then one element off
+    for (size_t shift : {0, 1}) {
+        Arr pb;
+        pb.reserve(shift + size);
+        for (size_t k = 0; k < shift; ++k)
+            pb.push_back(aosoa::soa::SoaElem<Types>(std::tuple(0., 0., 0, 0.f)));
+        for (size_t k = 0; k < size / num_dbl * num_dbl; k += num_dbl)
+            pb.template push_back<num_dbl>(std::as_const(src).template get<num_dbl>(k));
+        for (size_t k = size / num_dbl * num_dbl; k < size; ++k)
+            pb.push_back(src[k]);
+        ok = ok and pb.size() == shift + size;
+        for (size_t k = 0; k < size; ++k) {
+            auto p = pb[shift + k];
+            ok = ok and get<0>(p.pos()) == double(k) and get<1>(p.pos()) == -double(k)
+                    and p.id() == int32_t(k) and p.mass() == 0.5f * float(k);
+        }
+    }
+
+    // resize still zeroes the elements it adds
+    Arr pz;
+    pz.resize(size);
+    for (auto p : pz)
+        ok = ok and get<0>(p.pos()) == 0. and p.id() == 0 and p.mass() == 0.f;
+    return ok;
+}
+
+// Frames recycled through a pool keep their content with
+// resize_for_overwrite, and are zeroed by resize.
+bool test_no_zeroing() {
+    using List = aosoa::AosoaList<Types, 2*num_dbl>;
+    List::Pool pool(4, 1);
+    List pa(&pool);
+    pa.resize(8 * num_dbl);
+    for (auto p : pa)
+        p.id() = 7;
+    pa.clear();
+    pa.resize_for_overwrite(8 * num_dbl);
+    bool ok = pool.capacity() == 4;
+    for (auto p : pa)
+        ok = ok and p.id() == 7;
+    pa.clear();
+    pa.resize(8 * num_dbl);
+    for (auto p : pa)
+        ok = ok and p.id() == 0;
+    return ok;
+}
+
+int main() {
+    bool ok = test_no_zeroing();
+    for (size_t size : {0, 1, 5, 100, 4099}) {
+        ok = ok and test<aosoa::SoaVector<Types>>(size);
+        ok = ok and test<aosoa::AosoaVector<Types, 4*num_dbl>>(size);
+        ok = ok and test<aosoa::AosoaList<Types, 2*num_dbl>>(size);
+    }
+    cout << "Push back: " << (ok ? "OK" : "ERROR") << endl;
+}
@@ -0,0 +1,102 @@
+#include "../aosoa/aosoa.hpp"
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+
+using namespace std;
+
+SOA_DEFINE_ELEM(pos);
+SOA_DEFINE_ELEM(weight);
+SOA_DEFINE_ELEM(moment);
+SOA_DEFINE_ELEM(charge);
+
+using Charge = aosoa::fixed<int16_t, -1., 1.>;
+using Types = std::tuple<
+        pos<double>,
+        weight<aosoa::float16>,
+        moment<aosoa::bfloat16, 2>,
+        charge<Charge>>;
+
+constexpr size_t num_flt = aosoa::simd_width / sizeof(float);
+
+bool test_codecs() {
+    // every finite half and bfloat16 survives a round trip through float
+    for (uint32_t h = 0; h < 0x10000; ++h) {
+        if ((h & 0x7fff) > 0x7c00)
+            continue;
+        aosoa::float16 a;
+        a.bits = uint16_t(h);
+        aosoa::bfloat16 b;
+        b.bits = uint16_t(h);
+        if (aosoa::float16(float(a)).bits != h or aosoa::bfloat16(float(b)).bits != h)
+            return false;
+    }
+    // rounding, overflow and denormals
+    bool ok = float(aosoa::float16(1.f + 0x1p-11f)) == 1.f
+        and float(aosoa::float16(1.f + 0x1p-11f + 0x1p-20f)) == 1.f + 0x1p-10f
+        and float(aosoa::float16(65504.f)) == 65504.f
+        and std::isinf(float(aosoa::float16(1e6f)))
+        and float(aosoa::float16(0x1p-24f)) == 0x1p-24f
+        and std::isnan(float(aosoa::float16(NAN)))
+        and std::isnan(float(aosoa::bfloat16(NAN)));
+    ok = ok and float(Charge(-1.)) == -1.f and float(Charge(2.)) == 1.f
+        and std::abs(float(Charge(0.3)) - 0.3f) <= Charge::step;
+    return ok;
+}
+
+template<typename Arr>
+bool test(Arr& pa) {
+    const size_t size = pa.size();
+    int64_t i = 0;
+    for (auto p : pa) {
+        p.pos() = double(i);
+        p.weight() = float(i % 100) / 8;
+        p.moment() = std::tuple(float(i % 50), -0.5f);
+        p.charge() = (i % 11) / 10. - 0.5;
+        ++i;
+    }
+
+    // batches decode and encode whole registers at a time
+    for (auto p : pa.template range<num_flt>()) {
+        aosoa::encode(p.weight(), 2.f * aosoa::decode(p.weight()));
+        aosoa::encode(get<0>(p.moment()), aosoa::decode(get<0>(p.moment())) + aosoa::decode(get<1>(p.moment())));
+        aosoa::encode(p.charge(), -aosoa::decode(p.charge()));
+    }
+    for (size_t k = size / num_flt * num_flt; k < size; ++k) {
+        auto p = pa[k];
+        p.weight() = 2 * p.weight();
+        get<0>(p.moment()) = get<0>(p.moment()) + get<1>(p.moment());
+        p.charge() = -p.charge();
+    }
+
+    i = 0;
+    for (auto p : pa) {
+        const float q = (i % 11) / 10.f - 0.5f;
+        if (p.pos() != double(i) or float(p.weight()) != float(i % 100) / 4)
+            return false;
+        if (float(get<0>(p.moment())) != float(i % 50) - 0.5f or float(get<1>(p.moment())) != -0.5f)
+            return false;
+        if (std::abs(float(p.charge()) + q) > 2 * Charge::step)
+            return false;
+        ++i;
+    }
+    return size_t(i) == size;
+}
+
+int main() {
+    static_assert(aosoa::SoaVector<Types>::elem_size == sizeof(double) + 4 * sizeof(uint16_t));
+    bool ok = test_codecs();
+    for (size_t size : {0, 1, 100, 4099}) {
+        aosoa::AosoaVector<Types, 4*num_flt> a;
+        a.resize(size);
+        ok = ok and test(a);
+        aosoa::AosoaList<Types, 2*num_flt> b;
+        b.resize(size);
+        ok = ok and test(b);
+        aosoa::SoaVector<Types> c;
+        c.resize(size);
+        ok = ok and test(c);
+    }
+    cout << "Quantized: " << (ok ? "OK" : "ERROR") << endl;
+}
@@ -0,0 +1,86 @@
+#include "../aosoa/aosoa.hpp"
+#include <iostream>
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+using namespace std;
+
+SOA_DEFINE_ELEM(pos);
+SOA_DEFINE_ELEM(vel);
+SOA_DEFINE_ELEM(id);
+
+using Types = std::tuple<
+        pos<double, 2>,
+        vel<double, 3>,
+        id<int64_t>>;
+
+constexpr size_t num_dbl = aosoa::simd_width / sizeof(double);
+
+template<typename Arr>
+bool test(size_t size, aosoa::ThreadPool& pool, aosoa::ThreadPool& pool1) {
+    std::mt19937 gen(size);
+    std::uniform_real_distribution<double> dist(-1, 1);
+
+    Arr pa;
+    pa.resize(size);
+    int64_t i = 0;
+    for (auto p : pa) {
+        p.id() = i++;
+        tpa::assign(p.pos(), double(i));
+        p.vel() = std::tuple(dist(gen), dist(gen), dist(gen));
+    }
+
+    // integer valued sums are exact
+    auto ids = aosoa::reduce<num_dbl>(pa, [](auto p) { return p.id(); }, aosoa::ReduceMode::fast, pool);
+    auto pos = aosoa::reduce<num_dbl>(pa, [](auto p) { return p.pos(); }, aosoa::ReduceMode::fast, pool);
+    if (ids != int64_t(size) * (int64_t(size) - 1) / 2 or pos[0] != double(size) * (size + 1) / 2 or pos[1] != pos[0])
+        return false;
+
+    // deterministic mode does not depend on the number of threads
+    auto kinetic = [](auto p) { return p.vel(); };
+    auto e = aosoa::dot<num_dbl>(pa, kinetic, kinetic, aosoa::ReduceMode::deterministic, pool);
+    auto e1 = aosoa::dot<num_dbl>(pa, kinetic, kinetic, aosoa::ReduceMode::deterministic, pool1);
+    if (e != e1)
+        return false;
+    double expected = 0;
+    for (auto p : pa) {
+        auto [x, y, z] = p.vel();
+        expected += x*x + y*y + z*z;
+    }
+    if (std::abs(e - expected) > 1e-9 * (1 + expected))
+        return false;
+
+    auto [lo, hi] = aosoa::minmax<num_dbl>(pa, [](auto p) { return p.vel(); }, pool);
+    std::array<double, 3> elo{1, 1, 1}, ehi{-1, -1, -1};
+    for (auto p : pa) {
+        auto [x, y, z] = p.vel();
+        std::array<double, 3> v{x, y, z};
+        for (size_t d = 0; d < 3; ++d) {
+            elo[d] = std::min(elo[d], v[d]);
+            ehi[d] = std::max(ehi[d], v[d]);
+        }
+    }
+    if (size > 0 and (lo != elo or hi != ehi))
+        return false;
+
+    auto counts = aosoa::histogram<num_dbl>(pa, [](auto p) { return get<0>(p.vel()); }, -0.5, 0.5, 10, pool);
+    std::vector<size_t> ecounts(10, 0);
+    for (auto p : pa) {
+        double x = get<0>(p.vel());
+        if (x >= -0.5 and x < 0.5)
+            ++ecounts[std::min<size_t>(9, size_t(std::floor((x + 0.5) * 10)))];
+    }
+    return counts == ecounts;
+}
+
+int main() {
+    aosoa::ThreadPool pool(4), pool1(1);
+    bool ok = true;
+    for (size_t size : {0, 1, 100, 4099, 50000}) {
+        ok = ok and test<aosoa::AosoaVector<Types, 4*num_dbl>>(size, pool, pool1);
+        ok = ok and test<aosoa::AosoaList<Types, 3*num_dbl>>(size, pool, pool1);
+        ok = ok and test<aosoa::SoaVector<Types>>(size, pool, pool1);
+    }
+    cout << "Reduce: " << (ok ? "OK" : "ERROR") << endl;
+}
@@ -0,0 +1,75 @@
+#include "../aosoa/aosoa.hpp"
+#include <iostream>
+#include <cstdint>
+
+using namespace std;
+
+SOA_DEFINE_ELEM(pos);
+SOA_DEFINE_ELEM(id);
+
+using Types = std::tuple<
+        pos<double, 2>,
+        id<int64_t>>;
+
+constexpr size_t num_dbl = aosoa::simd_width / sizeof(double);
+
+template<typename Arr>
+bool test(size_t size) {
+    Arr pa;
+    pa.resize(size);
+    int64_t i = 0;
+    for (auto p : pa) {
+        p.id() = i;
+        tpa::assign(p.pos(), double(i % 3));
+        ++i;
+    }
+
+    // remove every element with id % 3 == 0
+    size_t removed = aosoa::remove_if<num_dbl>(pa, [](auto p) {
+        return get<0>(p.pos()) == 0.;
+    });
+
+    if (removed != (size + 2) / 3 or pa.size() != size - removed)
+        return false;
+
+    int64_t expected = 1;
+    for (auto p : pa) {
+        if (p.id() != expected or get<1>(p.pos()) != double(expected % 3))
+            return false;
+        expected += expected % 3 == 1 ? 1 : 2;
+    }
+    return true;
+}
+
+template<typename Arr>
+bool test_compact(size_t size) {
+    Arr pa;
+    pa.resize(size);
+    int64_t i = 0;
+    for (auto p : pa)
+        p.id() = i++;
+
+    // keep the first and the last element only
+    std::vector<uint64_t> keep((size + 63) / 64, 0);
+    keep[0] |= 1;
+    keep[(size-1) / 64] |= uint64_t(1) << ((size-1) % 64);
+    aosoa::compact(pa, keep);
+
+    return pa.size() == 2 and pa[0].id() == 0 and pa[1].id() == int64_t(size-1);
+}
+
+int main() {
+    bool ok = true;
+    for (size_t size : {1, 2, 3, 7, 64, 65, 100, 257, 1000}) {
+        ok = ok and test<aosoa::AosoaVector<Types, 4*num_dbl>>(size);
+        ok = ok and test<aosoa::AosoaVector<Types, 3*num_dbl>>(size);
+        ok = ok and test<aosoa::AosoaList<Types, 8*num_dbl>>(size);
+        ok = ok and test<aosoa::SoaVector<Types>>(size);
+        if (size > 1) {
+            ok = ok and test_compact<aosoa::AosoaVector<Types, 4*num_dbl>>(size);
+            ok = ok and test_compact<aosoa::AosoaList<Types, 3*num_dbl>>(size);
+            ok = ok and test_compact<aosoa::SoaVector<Types>>(size);
+        }
+    }
+    cout << "remove_if: " << (ok ? "OK" : "ERROR") << endl;
+}
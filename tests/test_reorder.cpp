@@ -0,0 +1,133 @@
+#include "../aosoa/aosoa.hpp"
+#include <iostream>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+
+using namespace std;
+
+SOA_DEFINE_ELEM(pos);
+SOA_DEFINE_ELEM(id);
+
+using Types = std::tuple<
+        pos<double, 3>,
+        id<int64_t>>;
+
+constexpr size_t num_dbl = aosoa::simd_width / sizeof(double);
+
+// The cells of an aligned square at the origin are consecutive on the
+// Hilbert curve, neighbours on the curve being neighbours in space.
+bool test_hilbert_2d() {
+    constexpr uint64_t w = 8;
+    std::vector<std::pair<uint64_t, std::array<uint64_t, 2>>> cells;
+    for (uint64_t x = 0; x < w; ++x)
+        for (uint64_t y = 0; y < w; ++y)
+            cells.push_back({aosoa::hilbert_key<2>(std::array<uint64_t, 2>{x, y}), {x, y}});
+    std::sort(cells.begin(), cells.end());
+    for (size_t k = 1; k < cells.size(); ++k) {
+        auto [a, b] = std::pair(cells[k-1].second, cells[k].second);
+        if (cells[k].first != cells[k-1].first + 1)
+            return false;
+        if (std::abs(int64_t(a[0]) - int64_t(b[0])) + std::abs(int64_t(a[1]) - int64_t(b[1])) != 1)
+            return false;
+    }
+    return true;
+}
+
+template<typename Arr>
+bool check(const Arr& pa, size_t size, aosoa::Curve curve, const aosoa::Bounds<3>& bounds) {
+    if (pa.size() != size)
+        return false;
+    std::vector<int> seen(size, 0);
+    uint64_t last = 0;
+    const double scale = double(uint64_t(1) << aosoa::curve_bits<3>);
+    for (auto p : pa) {
+        if (get<0>(p.pos()) != double(p.id()) / size)
+            return false;
+        ++seen[p.id()];
+        auto [x, y, z] = p.pos();
+        std::array<double, 3> r{x, y, z};
+        std::array<uint64_t, 3> q;
+        for (size_t i = 0; i < 3; ++i)
+            q[i] = uint64_t((r[i] - bounds.lo[i]) / (bounds.hi[i] - bounds.lo[i]) * scale);
+        uint64_t key = curve == aosoa::Curve::hilbert ? aosoa::hilbert_key<3>(q) : aosoa::morton_key<3>(q);
+        if (key < last)
+            return false;
+        last = key;
+    }
+    return std::all_of(seen.begin(), seen.end(), [](int s) { return s == 1; });
+}
+
+template<typename Arr, size_t S = num_dbl>
+bool test(size_t size, aosoa::Curve curve, aosoa::ThreadPool& pool) {
+    std::mt19937 gen(size);
+    std::uniform_real_distribution<double> dist(-1, 1);
+    const aosoa::Bounds<3> bounds{{-1, -1, 2}, {1, 1, 3}};
+
+    Arr pa;
+    pa.resize(size);
+    int64_t i = 0;
+    for (auto p : pa) {
+        p.id() = i;
+        p.pos() = std::tuple(double(i) / size, dist(gen), 2.5 + dist(gen) / 2);
+        ++i;
+    }
+
+    auto pos_fn = [](auto p) { return p.pos(); };
+    aosoa::reorder<S>(pa, pos_fn, bounds, curve, pool);
+    return check(pa, size, curve, bounds);
+}
+
+bool test_incremental(size_t size, aosoa::ThreadPool& pool) {
+    using Arr = aosoa::AosoaVector<Types, 4*num_dbl>;
+    std::mt19937 gen(size);
+    std::uniform_real_distribution<double> dist(-1, 1);
+    const aosoa::Bounds<3> bounds{{-1, -1, 2}, {1, 1, 3}};
+    auto pos_fn = [](auto p) { return p.pos(); };
+
+    Arr pa;
+    pa.resize(size);
+    int64_t i = 0;
+    for (auto p : pa) {
+        p.id() = i;
+        p.pos() = std::tuple(double(i) / size, dist(gen), 2.5 + dist(gen) / 2);
+        ++i;
+    }
+    aosoa::reorder(pa, pos_fn, bounds, aosoa::Curve::hilbert, pool);
+    // already in order, nothing to do with more than one frame
+    const size_t num_sorted = aosoa::reorder_incremental(pa, pos_fn, bounds, 4., aosoa::Curve::hilbert, pool);
+    if (pa.num_frames() > 1 and num_sorted != 0)
+        return false;
+
+    // move a few particles far away, their frames must be re-sorted
+    for (size_t k = 0; k < size; k += 97) {
+        auto p = pa[k];
+        get<1>(p.pos()) = -get<1>(p.pos());
+    }
+    aosoa::reorder_incremental(pa, pos_fn, bounds, 4., aosoa::Curve::hilbert, pool);
+
+    std::vector<int> seen(size, 0);
+    for (auto p : pa) {
+        if (get<0>(p.pos()) != double(p.id()) / size)
+            return false;
+        ++seen[p.id()];
+    }
+    return std::all_of(seen.begin(), seen.end(), [](int s) { return s == 1; });
+}
+
+int main() {
+    aosoa::ThreadPool pool(4);
+    bool ok = test_hilbert_2d();
+    for (size_t size : {0, 1, 100, 4099, 50000}) {
+        for (auto curve : {aosoa::Curve::morton, aosoa::Curve::hilbert}) {
+            ok = ok and test<aosoa::AosoaVector<Types, 4*num_dbl>>(size, curve, pool);
+            ok = ok and test<aosoa::AosoaList<Types, 3*num_dbl>>(size, curve, pool);
+            // frames and chunks that do not start on a multiple of S
+            ok = ok and test<aosoa::AosoaList<Types, 3*num_dbl>, 2*num_dbl>(size, curve, pool);
+            ok = ok and test<aosoa::SoaVector<Types>>(size, curve, pool);
+        }
+        if (size > 0)
+            ok = ok and test_incremental(size, pool);
+    }
+    cout << "Reorder: " << (ok ? "OK" : "ERROR") << endl;
+}
@@ -0,0 +1,67 @@
+#include "../aosoa/aosoa.hpp"
+#include <iostream>
+#include <cstdint>
+#include <numeric>
+#include <random>
+
+using namespace std;
+
+SOA_DEFINE_ELEM(pos);
+SOA_DEFINE_ELEM(count);
+SOA_DEFINE_ELEM(offset);
+
+using Types = std::tuple<
+        pos<double, 2>,
+        count<int64_t>,
+        offset<int64_t>>;
+
+constexpr size_t num_dbl = aosoa::simd_width / sizeof(double);
+
+template<typename Arr>
+bool test(size_t size, aosoa::ThreadPool& pool) {
+    std::mt19937 gen(size);
+    std::uniform_int_distribution<int64_t> dist(0, 10);
+
+    Arr pa;
+    pa.resize(size);
+    std::vector<int64_t> counts;
+    for (auto p : pa) {
+        p.count() = dist(gen);
+        get<0>(p.pos()) = double(p.count());
+        counts.push_back(p.count());
+    }
+
+    auto count = [](auto p) { return p.count(); };
+    auto offset = [](auto p) -> auto& { return p.offset(); };
+    auto x = [](auto p) -> auto& { return get<0>(p.pos()); };
+
+    std::vector<int64_t> expected(size);
+    std::exclusive_scan(counts.begin(), counts.end(), expected.begin(), int64_t(3));
+    aosoa::exclusive_scan<num_dbl>(pa, count, offset, int64_t(3), pool);
+    size_t k = 0;
+    for (auto p : pa)
+        if (p.offset() != expected[k++] or p.count() != counts[k-1])
+            return false;
+
+    // in place, integer valued doubles are exact
+    std::inclusive_scan(counts.begin(), counts.end(), expected.begin());
+    aosoa::inclusive_scan<num_dbl>(pa, x, 0., pool);
+    k = 0;
+    for (auto p : pa)
+        if (get<0>(p.pos()) != double(expected[k++]))
+            return false;
+    return true;
+}
+
+int main() {
+    aosoa::ThreadPool pool(4), pool1(1);
+    bool ok = true;
+    for (size_t size : {0, 1, 100, 4099, 50000}) {
+        for (auto* p : {&pool, &pool1}) {
+            ok = ok and test<aosoa::AosoaVector<Types, 4*num_dbl>>(size, *p);
+            ok = ok and test<aosoa::AosoaList<Types, 3*num_dbl>>(size, *p);
+            ok = ok and test<aosoa::SoaVector<Types>>(size, *p);
+        }
+    }
+    cout << "Scan: " << (ok ? "OK" : "ERROR") << endl;
+}
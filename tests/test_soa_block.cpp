@@ -0,0 +1,73 @@
+#include "../aosoa/aosoa.hpp"
+#include <iostream>
+#include <cstdint>
+#include <utility>
+
+using namespace std;
+
+SOA_DEFINE_ELEM(pos);
+SOA_DEFINE_ELEM(id);
+SOA_DEFINE_ELEM(flag);
+
+using Types = std::tuple<
+        pos<double, 3>,
+        id<int64_t>,
+        flag<uint8_t>>;
+
+using block_vec = aosoa::SoaVector<Types, aosoa::default_align, true>;
+
+constexpr size_t num_dbl = aosoa::simd_width / sizeof(double);
+
+bool check(const block_vec& pa, size_t size) {
+    bool ok = pa.size() == size;
+    ok = ok and uintptr_t(pa.column_data<3>()) % aosoa::default_align == 0
+            and uintptr_t(pa.column_data<4>()) % aosoa::default_align == 0;
+    int64_t i = 0;
+    for (auto p : pa) {
+        ok = ok and get<0>(p.pos()) == double(i) and get<2>(p.pos()) == 2. * i
+                and p.id() == i and p.flag() == uint8_t(i % 7);
+        ++i;
+    }
+    return ok;
+}
+
+bool test(size_t size) {
+    // growth by push_back and by resize move every column to the new block
+    block_vec pa;
+    for (size_t k = 0; k < size; ++k) {
+        auto p = pa.emplace_back();
+        p.pos() = std::tuple(double(k), 1., 2. * k);
+        p.id() = int64_t(k);
+        p.flag() = uint8_t(k % 7);
+    }
+    bool ok = check(pa, size);
+    pa.resize(2 * size + 1);
+    for (size_t k = size; k < pa.size(); ++k)
+        ok = ok and pa[k].id() == 0 and get<0>(pa[k].pos()) == 0.;
+    pa.resize(size);
+    pa.reserve(4 * size);
+    ok = ok and check(pa, size);
+
+    // copies own their block, moves take it
+    block_vec pb = pa, pc;
+    pc = pa;
+    for (auto p : pa)
+        p.id() = -1;
+    ok = ok and check(pb, size) and check(pc, size);
+    block_vec pd(std::move(pb));
+    ok = ok and check(pd, size) and pb.size() == 0;
+    pb = std::move(pd);
+    ok = ok and check(pb, size);
+
+    // column algorithms work on the block
+    const size_t removed = aosoa::remove_if<num_dbl>(pb, [](auto p) { return p.id() >= int64_t(10); });
+    ok = ok and removed == (size > 10 ? size - 10 : 0) and check(pb, std::min<size_t>(size, 10));
+    return ok;
+}
+
+int main() {
+    bool ok = true;
+    for (size_t size : {0, 1, 10, 100, 4099})
+        ok = ok and test(size);
+    cout << "SoaVector block: " << (ok ? "OK" : "ERROR") << endl;
+}
@@ -0,0 +1,64 @@
+#include "../aosoa/aosoa.hpp"
+#include <iostream>
+#include <cstdint>
+#include <random>
+
+using namespace std;
+
+SOA_DEFINE_ELEM(pos);
+SOA_DEFINE_ELEM(cell);
+SOA_DEFINE_ELEM(id);
+
+using Types = std::tuple<
+        pos<double, 3>,
+        cell<int32_t>,
+        id<int64_t>>;
+
+constexpr size_t num_dbl = aosoa::simd_width / sizeof(double);
+
+template<typename Arr>
+bool test(size_t size, int32_t num_cells, aosoa::ThreadPool& pool) {
+    std::mt19937 gen(size);
+    std::uniform_int_distribution<int32_t> dist(-num_cells, num_cells);
+
+    Arr pa;
+    pa.resize(size);
+    int64_t i = 0;
+    for (auto p : pa) {
+        p.cell() = dist(gen);
+        p.id() = i;
+        tpa::assign(p.pos(), double(p.cell()));
+        get<2>(p.pos()) = double(i);
+        ++i;
+    }
+
+    aosoa::sort_by_key(pa, [](auto p) { return p.cell(); }, pool);
+
+    if (pa.size() != size)
+        return false;
+    for (size_t k = 0; k < size; ++k) {
+        auto p = pa[k];
+        if (get<0>(p.pos()) != p.cell() or get<2>(p.pos()) != p.id())
+            return false;
+        if (k > 0) {
+            auto q = pa[k-1];
+            // stable sort
+            if (q.cell() > p.cell() or (q.cell() == p.cell() and q.id() >= p.id()))
+                return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    aosoa::ThreadPool pool(4);
+    bool ok = true;
+    for (size_t size : {0, 1, 2, 100, 4099, 50000}) {
+        for (int32_t num_cells : {0, 10, 100000}) {
+            ok = ok and test<aosoa::AosoaVector<Types, 4*num_dbl>>(size, num_cells, pool);
+            ok = ok and test<aosoa::AosoaList<Types, 3*num_dbl>>(size, num_cells, pool);
+            ok = ok and test<aosoa::SoaVector<Types>>(size, num_cells, pool);
+        }
+    }
+    cout << "sort_by_key: " << (ok ? "OK" : "ERROR") << endl;
+}
@@ -0,0 +1,80 @@
+#include "../aosoa/aosoa.hpp"
+#include <iostream>
+#include <cstdint>
+
+using namespace std;
+
+SOA_DEFINE_ELEM(pos);
+SOA_DEFINE_ELEM(id);
+
+using Types = std::tuple<
+        pos<double, 2>,
+        id<int64_t>>;
+
+constexpr size_t num_dbl = aosoa::simd_width / sizeof(double);
+
+template<typename Arr>
+bool test(size_t size) {
+    aosoa::Tombstoned<Arr> pa(0.5);
+    pa.resize(size);
+    int64_t i = 0;
+    for (auto p : pa.container()) {
+        p.id() = i;
+        tpa::assign(p.pos(), double(i % 4));
+        ++i;
+    }
+
+    // erase every element with id % 4 == 0, indices are kept
+    size_t erased = pa.template erase_if<num_dbl>([](auto p) { return get<0>(p.pos()) == 0.; });
+    if (erased != (size + 3) / 4 or pa.num_alive() != size - erased or pa.size() != size)
+        return false;
+    for (size_t k = 0; k < size; ++k)
+        if (pa.alive(k) != (k % 4 != 0) or pa[k].id() != int64_t(k))
+            return false;
+
+    // kernels only see the live elements
+    double sum = 0;
+    for (auto p : pa.template range<num_dbl>()) {
+        using batch_t = xsimd::make_sized_batch_t<double, num_dbl>;
+        sum += xsimd::reduce_add(xsimd::select(p.mask(), get<0>(p.pos()), batch_t(0.)));
+    }
+    double expected_sum = 0;
+    for (size_t k = 0; k < size; ++k)
+        expected_sum += k % 4;
+    if (sum != expected_sum)
+        return false;
+
+    // a quarter of holes is below the threshold
+    if (size > 1 and pa.maybe_compact())
+        return false;
+    if (size > 1)
+        pa.erase(1);
+    pa.set_max_hole_fraction(0.1);
+    if (size > 4 and not pa.maybe_compact())
+        return false;
+    pa.compact();
+
+    if (pa.num_holes() != 0 or pa.size() != size - erased - (size > 1))
+        return false;
+    int64_t expected = 2;
+    for (size_t k = 0; k < pa.size(); ++k) {
+        if (not pa.alive(k) or pa[k].id() != expected)
+            return false;
+        expected += expected % 4 == 3 ? 2 : 1;
+    }
+
+    // new slots are alive
+    pa.resize(pa.size() + 5);
+    return pa.num_alive() == pa.size() and pa.alive(pa.size() - 1);
+}
+
+int main() {
+    bool ok = true;
+    for (size_t size : {1, 2, 5, 64, 65, 100, 257, 1000}) {
+        ok = ok and test<aosoa::AosoaVector<Types, 4*num_dbl>>(size);
+        ok = ok and test<aosoa::AosoaVector<Types, 12*num_dbl>>(size);
+        ok = ok and test<aosoa::AosoaList<Types, 64>>(size);
+        ok = ok and test<aosoa::AosoaList<Types, 128>>(size);
+    }
+    cout << "Tombstones: " << (ok ? "OK" : "ERROR") << endl;
+}
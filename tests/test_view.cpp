@@ -0,0 +1,94 @@
+#include "../aosoa/aosoa.hpp"
+#include <iostream>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+SOA_DEFINE_ELEM(pos);
+SOA_DEFINE_ELEM(vel);
+SOA_DEFINE_ELEM(id);
+SOA_DEFINE_ELEM(mass);
+
+using Types = std::tuple<
+        pos<double, 2>,
+        id<int64_t>,
+        vel<double, 2>,
+        mass<double>>;
+
+constexpr size_t num_dbl = aosoa::simd_width / sizeof(double);
+
+template<typename Arr>
+void fill(Arr& pa) {
+    int64_t i = 0;
+    for (auto p : pa) {
+        p.pos() = std::tuple(double(i), 0.);
+        p.vel() = std::tuple(1., double(i));
+        p.id() = i;
+        p.mass() = 2.;
+        ++i;
+    }
+}
+
+template<typename Arr, typename Other>
+bool test(size_t size) {
+    Arr pa;
+    pa.resize(size);
+    fill(pa);
+
+    auto v = pa.template view<pos, vel>().with_prefetch(8 * num_dbl);
+    static_assert(decltype(v)::elem_size == 4 * sizeof(double));
+    static_assert(decltype(v)::columns[2] == 3);
+    for (auto p : v.template range<num_dbl>())
+        tpa::assign(get<0>(p.pos()), get<0>(p.pos()) + get<0>(p.vel()));
+    for (size_t k = size / num_dbl * num_dbl; k < size; ++k) {
+        auto p = v[k];
+        get<0>(p.pos()) += get<0>(p.vel());
+    }
+
+    bool ok = true;
+    int64_t i = 0;
+    for (auto p : std::as_const(pa).template view<pos, id>())
+        ok = ok and get<0>(p.pos()) == i + 1. and p.id() == i++;
+
+    // ranges of a temporary view hold a copy of it
+    size_t visited = 0;
+    for (auto p : std::as_const(pa).template view<id>().template range<num_dbl>())
+        visited += p.id().get(0) == int64_t(visited) ? num_dbl : 0;
+    for (auto p : std::as_const(pa).template view<id>().template urange<num_dbl>())
+        visited += p.id()[0] == int64_t(visited) ? 1 : 0;
+    ok = ok and visited == size;
+
+    // copy and serialize only pos and vel
+    Other pb;
+    pb.resize(size);
+    aosoa::copy_fields(pb.template view<pos, vel>(), v);
+    i = 0;
+    for (auto p : pb) {
+        ok = ok and get<0>(p.pos()) == i + 1. and get<1>(p.vel()) == double(i) and p.id() == 0;
+        ++i;
+    }
+
+    if (size > 10) {
+        vector<char> buf(v.serialize_size(10, size));
+        v.serialize(10, size, buf.data());
+        Other pc;
+        pc.resize(size - 10);
+        auto vc = pc.template view<pos, vel>();
+        ok = ok and vc.deserialize(0, buf.data()) == buf.data() + buf.size();
+        i = 10;
+        for (auto p : pc)
+            ok = ok and get<0>(p.pos()) == i + 1. and get<1>(p.vel()) == double(i++) and p.mass() == 0.;
+    }
+    return ok;
+}
+
+int main() {
+    bool ok = true;
+    for (size_t size : {0, 1, 100, 4099}) {
+        ok = ok and test<aosoa::AosoaVector<Types, 4*num_dbl>, aosoa::SoaVector<Types>>(size);
+        ok = ok and test<aosoa::AosoaList<Types, 3*num_dbl>, aosoa::AosoaVector<Types, 2*num_dbl>>(size);
+        ok = ok and test<aosoa::SoaVector<Types>, aosoa::AosoaList<Types, 2*num_dbl>>(size);
+    }
+    cout << "Views: " << (ok ? "OK" : "ERROR") << endl;
+}
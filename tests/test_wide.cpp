@@ -0,0 +1,70 @@
+#include "../aosoa/aosoa.hpp"
+#include <iostream>
+#include <cstdint>
+
+using namespace std;
+
+SOA_DEFINE_ELEM(pos);
+SOA_DEFINE_ELEM(vel);
+SOA_DEFINE_ELEM(id);
+
+using Types = std::tuple<
+        pos<double, 2>,
+        vel<float, 2>,
+        id<int32_t>>;
+
+// lanes of a float or int32_t batch, i.e. two double batches
+constexpr size_t S = aosoa::wide_lanes<Types>;
+
+template<typename Arr>
+bool test(Arr& pa) {
+    const size_t size = pa.size();
+    int64_t i = 0;
+    for (auto p : pa) {
+        p.pos() = std::tuple(double(i), 0.);
+        p.vel() = std::tuple(float(i % 7), 1.f);
+        p.id() = 0;
+        ++i;
+    }
+
+    for (auto p : pa.wrange()) {
+        auto& x = get<0>(p.pos());
+        tpa::assign(x, x + 0.5 * aosoa::convert<double>(get<0>(p.vel())));
+        tpa::assign(p.id(), aosoa::convert<int32_t>(x));
+    }
+    for (size_t k = size / S * S; k < size; ++k) {
+        auto p = pa[k];
+        get<0>(p.pos()) += 0.5 * get<0>(p.vel());
+        p.id() = int32_t(get<0>(p.pos()));
+    }
+
+    i = 0;
+    for (auto p : pa) {
+        const double x = i + 0.5 * (i % 7);
+        if (get<0>(p.pos()) != x or p.id() != int32_t(x))
+            return false;
+        ++i;
+    }
+    return size_t(i) == size;
+}
+
+int main() {
+    static_assert(S == aosoa::native_lanes<float>);
+    static_assert(std::is_same_v<aosoa::wide_t<double, S>,
+            std::array<xsimd::simd_type<double>, S / aosoa::native_lanes<double>>>);
+    bool ok = true;
+    for (size_t size : {0, 1, 100, 4099}) {
+        aosoa::AosoaVector<Types, 2*S> a;
+        a.resize(size);
+        ok = ok and test(a);
+        aosoa::AosoaList<Types, 3*S> b;
+        b.resize(size);
+        ok = ok and test(b);
+        aosoa::SoaVector<Types> c;
+        c.resize(size);
+        ok = ok and test(c);
+    }
+    aosoa::SoaArray<Types, 4*S> d;
+    ok = ok and test(d);
+    cout << "Wide: " << (ok ? "OK" : "ERROR") << endl;
+}
@@ -0,0 +1,83 @@
+#include "../aosoa/aosoa.hpp"
+#include <iostream>
+#include <cmath>
+
+using namespace std;
+
+SOA_DEFINE_ELEM(pos);
+SOA_DEFINE_ELEM(weight);
+
+using Types = std::tuple<
+        pos<double, 3>,
+        weight<double>>;
+
+constexpr size_t num_dbl = aosoa::simd_width / sizeof(double);
+using particle_list = aosoa::AosoaList<Types, 8*num_dbl>;
+
+int main() {
+    aosoa::ThreadPool pool(4);
+    aosoa::WorkStealingExecutor exec(pool);
+
+    particle_list pa;
+    pa.resize(100000 + 3);
+    int i = 0;
+    for (auto p : pa)
+        p.weight() = i++;
+
+    // very uneven cost: only the first frames are expensive
+    exec.for_each<num_dbl>(pa, [](auto p) {
+        auto& w = p.weight();
+        double first;
+        if constexpr (requires { w.get(0); })
+            first = w.get(0);   // simd batch
+        else
+            first = w[0];       // std::array of the tail
+        if (first < 5000)
+            for (auto k = 0; k < 200; ++k)
+                tpa::assign(p.pos(), p.pos() + 1e-3);
+        else
+            tpa::assign(p.pos(), 1);
+    });
+
+    bool ok = true;
+    i = 0;
+    for (auto p : pa) {
+        double expected = i < 5000 ? 0.2 : 1;
+        if (std::abs(get<0>(p.pos()) - expected) > 1e-9)
+            ok = false;
+        ++i;
+    }
+    cout << "Frames: " << (ok ? "OK" : "ERROR") << endl;
+
+    const auto& stats = exec.stats();
+    size_t total_tasks = 0;
+    for (size_t t = 0; t < exec.num_threads(); ++t) {
+        cout << "thread " << t << ": tasks " << stats.num_tasks[t] << ", steals " << stats.num_steals[t]
+            << ", busy " << stats.busy[t] << "s, idle " << stats.idle[t] << "s" << endl;
+        total_tasks += stats.num_tasks[t];
+    }
+    cout << "Imbalance: " << stats.imbalance() << endl;
+    cout << "All frames run once: " << (total_tasks == pa.num_frames() ? "OK" : "ERROR") << endl;
+
+    // one container per cell
+    vector<particle_list> cells(37);
+    for (size_t c = 0; c < cells.size(); ++c)
+        cells[c].resize(c * 13);
+    exec.for_each<num_dbl>(cells, [](auto p) { tpa::assign(p.weight(), 2); });
+    ok = true;
+    for (auto& cell : cells)
+        for (auto p : cell)
+            if (p.weight() != 2)
+                ok = false;
+    cout << "Cells: " << (ok ? "OK" : "ERROR") << endl;
+
+    // frames that are not a multiple of S are visited exactly once
+    aosoa::AosoaList<Types, 3*num_dbl> odd;
+    odd.resize(1000 * num_dbl + 5);
+    exec.for_each<2*num_dbl>(odd, [](auto p) { tpa::assign(p.weight(), p.weight() + 1.); });
+    ok = true;
+    for (auto p : odd)
+        if (p.weight() != 1)
+            ok = false;
+    cout << "Odd frames: " << (ok ? "OK" : "ERROR") << endl;
+}
@@ -0,0 +1,66 @@
+#include "../aosoa/aosoa.hpp"
+#include <iostream>
+#include <stdexcept>
+#include <cstdint>
+
+using namespace std;
+
+SOA_DEFINE_ELEM(pos);
+SOA_DEFINE_ELEM(vel);
+SOA_DEFINE_ELEM(force);
+SOA_DEFINE_ELEM(id);
+
+using Types = std::tuple<
+        pos<double, 2>,
+        vel<double, 2>,
+        id<int64_t>>;
+
+using Scratch = std::tuple<force<double, 2>>;
+
+constexpr size_t num_dbl = aosoa::simd_width / sizeof(double);
+
+template<typename Arr, typename Aux>
+bool test(size_t size) {
+    Arr pa;
+    Aux fa;
+    pa.resize(size);
+    fa.resize(size);
+    int64_t i = 0;
+    for (auto [p, f] : aosoa::zip_range(pa, fa)) {
+        p.id() = i;
+        tpa::assign(p.vel(), 0.);
+        tpa::assign(p.pos(), double(i));
+        tpa::assign(f.force(), double(2*i));
+        ++i;
+    }
+
+    for (auto [p, f] : aosoa::zip_range<num_dbl>(pa, fa))
+        tpa::assign(p.vel(), f.force());
+    for (auto [p, f] : aosoa::zip_urange<num_dbl>(pa, fa))
+        tpa::assign(p.vel(), f.force());
+
+    const auto& cpa = pa;
+    for (auto [p, f] : aosoa::zip_range(cpa, fa))
+        if (get<0>(p.vel()) != 2 * p.id() or get<1>(p.vel()) != get<1>(f.force()))
+            return false;
+
+    // containers of different sizes are rejected
+    fa.resize(size + 1);
+    try {
+        for (auto [p, f] : aosoa::zip_range(pa, fa))
+            p.id() = -1;
+        return false;
+    }
+    catch (const std::invalid_argument&) {}
+    return size_t(i) == size;
+}
+
+int main() {
+    bool ok = true;
+    for (size_t size : {0, 1, 3, 100, 4099}) {
+        ok = ok and test<aosoa::AosoaVector<Types, 4*num_dbl>, aosoa::SoaVector<Scratch>>(size);
+        ok = ok and test<aosoa::AosoaList<Types, 3*num_dbl>, aosoa::AosoaVector<Scratch, 2*num_dbl>>(size);
+        ok = ok and test<aosoa::SoaVector<Types>, aosoa::SoaVector<Scratch>>(size);
+    }
+    cout << "Zip: " << (ok ? "OK" : "ERROR") << endl;
+}